@@ -0,0 +1,191 @@
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include <array>
+#include <random>
+#include <chrono>
+#include <boost/program_options.hpp>
+
+#include <evaluators/batch_evaluator.h>
+
+#ifndef BATCH_GENES
+#define BATCH_GENES 64
+#endif
+
+#ifndef BATCH_OUTPUTS
+#define BATCH_OUTPUTS 32
+#endif
+
+namespace po = boost::program_options;
+
+const size_t Genes = BATCH_GENES;
+const size_t Outputs = BATCH_OUTPUTS;
+
+using Genome = std::array<double, Genes>;
+using Candidate = pr::Candidate<Genome, double>;
+using Population = pr::Population<Candidate>;
+
+//! Squared error of a linear model y = W x, with W stored row-major.
+struct Model {
+  std::vector<double> weights;
+  std::vector<double> target;
+};
+
+//! The per-candidate path: one matrix-vector product per genome.
+class LinearEvaluator : public pr::Evaluator<Candidate> {
+  public:
+    LinearEvaluator(const Model& model) : m_model(model) {}
+
+    void evaluate(Population& pop) {
+      std::vector<size_t> indices = pr::stale(pop);
+
+      #pragma omp parallel for schedule(dynamic)
+      for (long k = 0; k < static_cast<long>(indices.size()); k++) {
+        Candidate& cnd = pop[indices[k]];
+        const Genome& x = pr::progeny(cnd);
+        double error = 0;
+        for (size_t m = 0; m < Outputs; m++) {
+          const double* w = &m_model.weights[m * Genes];
+          double y = -m_model.target[m];
+          for (size_t j = 0; j < Genes; j++) {
+            y += w[j] * x[j];
+          }
+          error += y * y;
+        }
+        pr::fitness(cnd) = error;
+        cnd.valid = true;
+      }
+    }
+
+  private:
+    const Model& m_model;
+};
+
+//! The batched path: Y = W X over the gene-major batch. Tiles of four
+//! outputs by eight candidates stay in registers while the genes stream
+//! by, each gene load feeding four multiply-adds.
+pr::BatchEvaluator<Candidate>::Score batchScore(const Model& model) {
+  static_assert(Outputs % 4 == 0, "Outputs come in tiles of four.");
+
+  return [&model](const pr::Batch<double>& batch, double* fitness) {
+    const size_t Lanes = 8;
+    double error[Lanes];
+
+    for (size_t b0 = 0; b0 < batch.size(); b0 += Lanes) {
+      std::fill(error, error + Lanes, 0.0);
+
+      for (size_t m = 0; m < Outputs; m += 4) {
+        const double* w = &model.weights[m * Genes];
+        double y[4][Lanes];
+        for (size_t o = 0; o < 4; o++) {
+          std::fill(y[o], y[o] + Lanes, -model.target[m + o]);
+        }
+
+        for (size_t j = 0; j < Genes; j++) {
+          const double* x = batch.gene(j) + b0;
+          for (size_t o = 0; o < 4; o++) {
+            double wj = w[o * Genes + j];
+            for (size_t l = 0; l < Lanes; l++) {
+              y[o][l] += wj * x[l];
+            }
+          }
+        }
+
+        for (size_t o = 0; o < 4; o++) {
+          for (size_t l = 0; l < Lanes; l++) {
+            error[l] += y[o][l] * y[o][l];
+          }
+        }
+      }
+
+      size_t lanes = std::min(Lanes, batch.size() - b0);
+      std::copy(error, error + lanes, fitness + b0);
+    }
+  };
+}
+
+template <typename EType>
+double run(EType& evaluator, Population& pop, size_t rounds,
+    double& checksum) {
+  auto start = std::chrono::steady_clock::now();
+  checksum = 0;
+  for (size_t r = 0; r < rounds; r++) {
+    for (auto& cnd : pop) {
+      cnd.valid = false;
+    }
+    evaluator.evaluate(pop);
+    checksum += pr::fitness(pop[r % pop.size()]);
+  }
+  std::chrono::duration<double> elapsed =
+    std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+int main(int argc, char** argv) {
+  size_t size;
+  size_t rounds;
+
+  po::options_description desc("Recognized options");
+  desc.add_options()
+    ("help", "Print this help message.")
+    ("size", po::value<size_t>(&size)->default_value(65536),
+      "Population size.")
+    ("rounds", po::value<size_t>(&rounds)->default_value(20),
+      "Evaluations to time.");
+
+  po::variables_map vm;
+  po::store(po::command_line_parser(argc, argv).options(desc).run(), vm);
+  po::notify(vm);
+
+  if (vm.count("help")) {
+    std::cout << desc << std::endl;
+    return 0;
+  }
+
+  std::mt19937 mt(42);
+  std::normal_distribution<double> normal;
+
+  Model model;
+  model.weights.resize(Outputs * Genes);
+  model.target.resize(Outputs);
+  for (auto& w : model.weights) {
+    w = normal(mt);
+  }
+  for (auto& t : model.target) {
+    t = normal(mt);
+  }
+
+  Population pop(size);
+  for (auto& cnd : pop) {
+    for (auto& g : pr::progeny(cnd)) {
+      g = normal(mt);
+    }
+    cnd.alive = true;
+  }
+
+  std::cout << Genes << " genes, " << Outputs << " outputs, " << size
+    << " candidates, " << rounds << " rounds" << std::endl;
+  std::cout << std::setw(16) << std::left << "path" << std::right
+    << std::setw(12) << "time [s]" << std::setw(16) << "candidates/s"
+    << "   checksum" << std::endl;
+
+  auto report = [&](const std::string& name, double seconds,
+      double checksum) {
+    std::cout << std::setw(16) << std::left << name << std::right
+      << std::fixed << std::setprecision(4) << std::setw(12) << seconds
+      << std::setw(16) << std::setprecision(0) << size * rounds / seconds
+      << "   " << std::setprecision(6) << checksum << std::endl;
+  };
+
+  double checksum;
+  LinearEvaluator single(model);
+  double seconds = run(single, pop, rounds, checksum);
+  report("per-candidate", seconds, checksum);
+
+  // Batches are padded to whole tiles of eight candidates.
+  for (size_t batch : { 16, 64, 256, 1024 }) {
+    pr::BatchEvaluator<Candidate> batched(batchScore(model), batch);
+    seconds = run(batched, pop, rounds, checksum);
+    report("batch " + std::to_string(batch), seconds, checksum);
+  }
+}
@@ -0,0 +1,174 @@
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include <array>
+#include <string>
+#include <random>
+#include <chrono>
+#include <numeric>
+#include <boost/program_options.hpp>
+
+#include <mutators/point.h>
+#include <evaluators/queens_evaluator.h>
+#include <evaluators/mismatch_evaluator.h>
+
+#ifndef QUEENS
+#define QUEENS 10000
+#endif
+
+namespace po = boost::program_options;
+
+const int Q = QUEENS;
+
+using Board = std::array<int, Q>;
+using Queens = pr::Candidate<Board, long>;
+using Text = pr::Candidate<std::string, long>;
+
+//! The pairwise count of examples/nqueens, O(Q^2) per board.
+class PairwiseEvaluator : public pr::Evaluator<Queens> {
+  public:
+    void evaluate(pr::Population<Queens>& pop) {
+      std::vector<size_t> indices = pr::stale(pop);
+
+      #pragma omp parallel for schedule(dynamic)
+      for (long k = 0; k < static_cast<long>(indices.size()); k++) {
+        Queens& cnd = pop[indices[k]];
+        const Board& board = pr::progeny(cnd);
+        long attacks = 0;
+        for (int col = 0; col < Q; col++) {
+          for (int adv = col + 1; adv < Q; adv++) {
+            int d = board[adv] - board[col];
+            attacks += (d == 0) | (d == adv - col) | (d == col - adv);
+          }
+        }
+        pr::fitness(cnd) = attacks;
+        cnd.valid = true;
+      }
+    }
+};
+
+//! Times rounds of one point mutation per member followed by an
+//! evaluation. Without tracking, every evaluation scores in full. Every
+//! run makes the same mutations, so equal checksums mean equal fitness.
+template <typename CType, typename EType>
+double run(pr::Point<CType>& point, EType& evaluator,
+    pr::Population<CType>& pop, size_t rounds, bool tracking,
+    double& checksum) {
+  point.seed(pr::Random(7));
+  evaluator.evaluate(pop);
+
+  auto start = std::chrono::steady_clock::now();
+  checksum = 0;
+  for (size_t r = 0; r < rounds; r++) {
+    point.mutate(pop);
+    if (!tracking) {
+      for (auto& cnd : pop) {
+        cnd.changes.invalidate();
+      }
+    }
+    evaluator.evaluate(pop);
+    for (auto& cnd : pop) {
+      checksum += pr::fitness(cnd);
+    }
+  }
+  std::chrono::duration<double> elapsed =
+    std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+int main(int argc, char** argv) {
+  size_t size;
+  size_t pairwiseSize;
+  size_t rounds;
+
+  po::options_description desc("Recognized options");
+  desc.add_options()
+    ("help", "Print this help message.")
+    ("size", po::value<size_t>(&size)->default_value(256),
+      "Population size.")
+    ("pairwise-size", po::value<size_t>(&pairwiseSize)->default_value(8),
+      "Population size for the O(Q^2) evaluator.")
+    ("rounds", po::value<size_t>(&rounds)->default_value(10),
+      "Mutation and evaluation rounds to time.");
+
+  po::variables_map vm;
+  po::store(po::command_line_parser(argc, argv).options(desc).run(), vm);
+  po::notify(vm);
+
+  if (vm.count("help")) {
+    std::cout << desc << std::endl;
+    return 0;
+  }
+
+  std::mt19937 mt(42);
+  std::uniform_int_distribution<int> row(0, Q - 1);
+
+  pr::Population<Queens> boards(size);
+  for (auto& cnd : boards) {
+    std::generate(pr::progeny(cnd).begin(), pr::progeny(cnd).end(),
+      [&]() { return row(mt); });
+    cnd.alive = true;
+  }
+  std::vector<int> rows(Q);
+  std::iota(rows.begin(), rows.end(), 0);
+  pr::Point<Queens> move(rows, 1.0);
+
+  std::string target(Q, 'a');
+  std::uniform_int_distribution<int> letter('a', 'z');
+  for (auto& c : target) {
+    c = letter(mt);
+  }
+  pr::Population<Text> texts;
+  for (size_t i = 0; i < size; i++) {
+    std::string text(Q, 'a');
+    for (auto& c : text) {
+      c = letter(mt);
+    }
+    texts.push_back(Text(text));
+  }
+  std::vector<char> letters(26);
+  std::iota(letters.begin(), letters.end(), 'a');
+  pr::Point<Text> edit(letters, 1.0);
+
+  std::cout << "Q = " << Q << ", " << size << " candidates, " << rounds
+    << " rounds of one point mutation each" << std::endl;
+  std::cout << std::setw(24) << std::left << "path" << std::right
+    << std::setw(12) << "time [s]" << std::setw(16) << "candidates/s"
+    << "   checksum" << std::endl;
+
+  auto report = [&](const std::string& name, size_t candidates,
+      double seconds, double checksum) {
+    std::cout << std::setw(24) << std::left << name << std::right
+      << std::fixed << std::setprecision(4) << std::setw(12) << seconds
+      << std::setw(16) << std::setprecision(0)
+      << candidates * rounds / seconds
+      << "   " << std::setprecision(0) << checksum << std::endl;
+  };
+
+  double checksum;
+  double seconds;
+
+  pr::Population<Queens> few;
+  few.insert(few.end(), boards.begin(),
+    boards.begin() + std::min(pairwiseSize, size));
+  PairwiseEvaluator pairwise;
+  seconds = run(move, pairwise, few, rounds, false, checksum);
+  report("queens pairwise", few.size(), seconds, checksum);
+
+  pr::Population<Queens> copy = boards;
+  pr::QueensEvaluator<Queens> queens;
+  seconds = run(move, queens, copy, rounds, false, checksum);
+  report("queens counting", size, seconds, checksum);
+
+  seconds = run(move, queens, boards, rounds, true, checksum);
+  report("queens delta", size, seconds, checksum);
+
+  pr::Population<Text> texts2 = texts;
+  pr::MismatchEvaluator<Text> mismatch(target);
+  seconds = run(edit, mismatch, texts2, rounds, false, checksum);
+  report("mismatch full", size, seconds, checksum);
+
+  pr::DeltaMismatchEvaluator<Text> deltaMismatch(target);
+  seconds = run(edit, deltaMismatch, texts, rounds, true, checksum);
+  report("mismatch delta", size, seconds, checksum);
+}
@@ -0,0 +1,108 @@
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <boost/program_options.hpp>
+
+#include <util/mismatch_kernels.h>
+
+namespace po = boost::program_options;
+
+//! The element-by-element loop MismatchEvaluator used before the kernels.
+size_t naive(const std::string& a, const std::string& b) {
+  size_t error = 0;
+  for (size_t i = 0; i < a.size(); i++) {
+    if (!(a[i] == b[i])) {
+      error += 1;
+    }
+  }
+  return error;
+}
+
+int main(int argc, char** argv) {
+  size_t length;
+  size_t count;
+  size_t rounds;
+
+  po::options_description desc("Recognized options");
+  desc.add_options()
+    ("help", "Print this help message.")
+    ("length", po::value<size_t>(&length)->default_value(4096),
+      "Characters per genome.")
+    ("count", po::value<size_t>(&count)->default_value(4096),
+      "Genomes compared per round.")
+    ("rounds", po::value<size_t>(&rounds)->default_value(50),
+      "Rounds to time.");
+
+  po::variables_map vm;
+  po::store(po::command_line_parser(argc, argv).options(desc).run(), vm);
+  po::notify(vm);
+
+  if (vm.count("help")) {
+    std::cout << desc << std::endl;
+    return 0;
+  }
+
+  std::mt19937 mt(42);
+  std::uniform_int_distribution<int> letter('a', 'z');
+
+  std::string target(length, 0);
+  for (auto& c : target) {
+    c = letter(mt);
+  }
+  std::vector<std::string> genomes(count, target);
+  for (auto& g : genomes) {
+    for (auto& c : g) {
+      c = letter(mt);
+    }
+  }
+
+  using Clock = std::chrono::steady_clock;
+  auto report = [&](const std::string& name, Clock::duration elapsed,
+      size_t checksum) {
+    double seconds = std::chrono::duration<double>(elapsed).count();
+    double bytes = static_cast<double>(length) * count * rounds;
+    std::cout << std::setw(10) << std::left << name
+      << std::setw(12) << std::right << std::fixed << std::setprecision(3)
+      << seconds << " s" << std::setw(12) << bytes / seconds / 1e9
+      << " GB/s   checksum " << checksum << std::endl;
+  };
+
+  size_t checksum = 0;
+  auto start = Clock::now();
+  for (size_t r = 0; r < rounds; r++) {
+    for (auto& g : genomes) {
+      checksum += naive(target, g);
+    }
+  }
+  report("naive", Clock::now() - start, checksum);
+
+  const char* names[] = { "scalar", "sse2", "avx2", "avx512" };
+  for (pr::Isa isa : { pr::Isa::Scalar, pr::Isa::SSE2, pr::Isa::AVX2,
+      pr::Isa::AVX512 }) {
+    if (isa > pr::detectIsa()) {
+      continue;
+    }
+
+    pr::MismatchFn kernel = pr::MismatchKernels<1>::get(isa);
+    checksum = 0;
+    start = Clock::now();
+    for (size_t r = 0; r < rounds; r++) {
+      for (size_t g = 0; g < count; g += pr::MismatchBatch) {
+        const void* samples[pr::MismatchBatch];
+        size_t counts[pr::MismatchBatch];
+        size_t batch = std::min(pr::MismatchBatch, count - g);
+        for (size_t s = 0; s < batch; s++) {
+          samples[s] = genomes[g + s].data();
+        }
+        kernel(target.data(), samples, batch, length, counts);
+        for (size_t s = 0; s < batch; s++) {
+          checksum += counts[s];
+        }
+      }
+    }
+    report(names[static_cast<int>(isa)], Clock::now() - start, checksum);
+  }
+}
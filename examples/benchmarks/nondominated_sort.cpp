@@ -0,0 +1,135 @@
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <boost/program_options.hpp>
+
+#include <selectors/nsga_selector.h>
+
+namespace po = boost::program_options;
+
+//! Deb's fast non-dominated sort, O(MN^2) time and O(N^2) memory.
+std::vector<size_t> naiveSort(const std::vector<double>& keys, size_t n,
+    size_t m) {
+  auto dominates = [&](size_t a, size_t b) {
+    bool better = false;
+    for (size_t j = 0; j < m; j++) {
+      if (keys[b * m + j] < keys[a * m + j]) {
+        return false;
+      }
+      better = better || keys[a * m + j] < keys[b * m + j];
+    }
+    return better;
+  };
+
+  std::vector<std::vector<size_t>> dominated(n);
+  std::vector<size_t> count(n, 0);
+  std::vector<size_t> rank(n, 0);
+  std::vector<size_t> front;
+
+  for (size_t p = 0; p < n; p++) {
+    for (size_t q = 0; q < n; q++) {
+      if (dominates(p, q)) {
+        dominated[p].push_back(q);
+      } else if (dominates(q, p)) {
+        count[p]++;
+      }
+    }
+    if (count[p] == 0) {
+      front.push_back(p);
+    }
+  }
+
+  for (size_t r = 0; !front.empty(); r++) {
+    std::vector<size_t> next;
+    for (size_t p : front) {
+      rank[p] = r;
+      for (size_t q : dominated[p]) {
+        if (--count[q] == 0) {
+          next.push_back(q);
+        }
+      }
+    }
+    front.swap(next);
+  }
+  return rank;
+}
+
+template <typename FType>
+double seconds(FType f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  std::chrono::duration<double> elapsed =
+    std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+int main(int argc, char** argv) {
+  size_t naive_limit;
+  unsigned int seed;
+
+  po::options_description desc("Recognized options");
+  desc.add_options()
+    ("help", "Print this help message.")
+    ("naive-limit", po::value<size_t>(&naive_limit)->default_value(20000),
+      "Largest population the naive sort is run on.")
+    ("seed", po::value<unsigned int>(&seed)->default_value(42),
+      "Seed for the RNG.");
+
+  po::variables_map vm;
+  po::store(po::command_line_parser(argc, argv).options(desc).run(), vm);
+  po::notify(vm);
+
+  if (vm.count("help")) {
+    std::cout << desc << std::endl;
+    return 0;
+  }
+
+  std::mt19937 mt(seed);
+  std::uniform_real_distribution<double> dist(0.0, 1.0);
+
+  std::cout << std::setw(4) << "M" << std::setw(10) << "N"
+    << std::setw(12) << "fronts" << std::setw(14) << "ens-bs [s]"
+    << std::setw(14) << "naive [s]" << std::setw(14) << "crowding [s]"
+    << std::endl;
+
+  for (size_t m : {2, 3, 5}) {
+    // Fronts grow large with more objectives; keep those runs short.
+    size_t largest = m == 2 ? 1000000 : 100000;
+    for (size_t n = 1000; n <= largest; n *= 10) {
+      std::vector<double> keys(n * m);
+      for (auto& k : keys) {
+        k = dist(mt);
+      }
+
+      std::vector<size_t> rank;
+      double fast = seconds([&]{ rank = pr::nondominatedSort(keys, n, m); });
+
+      std::vector<size_t> front;
+      for (size_t i = 0; i < n; i++) {
+        if (rank[i] == 0) {
+          front.push_back(i);
+        }
+      }
+      double crowd = seconds([&]{ pr::crowdingDistance(keys, m, front); });
+
+      std::cout << std::setw(4) << m << std::setw(10) << n
+        << std::setw(12) << *std::max_element(rank.begin(), rank.end()) + 1
+        << std::setw(14) << std::fixed << std::setprecision(4) << fast;
+
+      if (n <= naive_limit) {
+        std::vector<size_t> reference;
+        double naive = seconds([&]{ reference = naiveSort(keys, n, m); });
+        std::cout << std::setw(14) << naive;
+        if (reference != rank) {
+          std::cout << " MISMATCH";
+        }
+      } else {
+        std::cout << std::setw(14) << "-";
+      }
+      std::cout << std::setw(14) << crowd << std::endl;
+    }
+  }
+}
@@ -0,0 +1,135 @@
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <random>
+#include <chrono>
+#include <boost/program_options.hpp>
+
+#include <core/bit_string.h>
+#include <evaluators/mismatch_evaluator.h>
+#include <evaluators/hamming_evaluator.h>
+#include <mutators/crossover.h>
+#include <mutators/bit_flip.h>
+
+#ifndef ONEMAX_BITS
+#define ONEMAX_BITS 4096
+#endif
+
+namespace po = boost::program_options;
+
+using Bits = pr::BitString<ONEMAX_BITS>;
+
+//! Bit-flip mutation on the '0'/'1' string encoding, one byte per gene.
+//! It jumps between flips with geometric gaps, as BitFlip does at low
+//! rates, so that only the encoding differs.
+template <typename CType>
+class StringFlip : public pr::Mutator<CType> {
+
+  using Population = pr::Population<CType>;
+
+  public:
+    StringFlip(double rate) : m_gap(rate) {}
+
+    void mutate(Population& pop) {
+      for (auto& cnd : pop) {
+        std::string& genes = pr::progeny(cnd);
+        for (size_t i = m_gap(m_mt); i < genes.size(); i += m_gap(m_mt) + 1) {
+          genes[i] = genes[i] == '0' ? '1' : '0';
+        }
+        cnd.valid = false;
+      }
+    }
+
+  private:
+    std::mt19937 m_mt;
+    std::geometric_distribution<size_t> m_gap;
+};
+
+struct Timings {
+  double crossover = 0;
+  double flip = 0;
+  double evaluate = 0;
+};
+
+template <typename FType>
+double seconds(FType f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  std::chrono::duration<double> elapsed =
+    std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+//! Times the operators of one OneMax generation for a genome encoding.
+template <typename CType, typename Crossover, typename Flip, typename Eval>
+Timings run(pr::Population<CType> pop, Crossover crossover, Flip flip,
+    Eval evaluator, size_t rounds) {
+  Timings t;
+  for (size_t r = 0; r < rounds; r++) {
+    t.crossover += seconds([&]{ crossover.mutate(pop); });
+    t.flip += seconds([&]{ flip.mutate(pop); });
+    t.evaluate += seconds([&]{ evaluator.evaluate(pop); });
+  }
+  return t;
+}
+
+void report(const std::string& name, const Timings& t) {
+  std::cout << std::setw(12) << std::left << name << std::right
+    << std::fixed << std::setprecision(4)
+    << std::setw(14) << t.crossover << std::setw(14) << t.flip
+    << std::setw(14) << t.evaluate
+    << std::setw(14) << t.crossover + t.flip + t.evaluate << std::endl;
+}
+
+int main(int argc, char** argv) {
+  size_t size;
+  size_t rounds;
+
+  po::options_description desc("Recognized options");
+  desc.add_options()
+    ("help", "Print this help message.")
+    ("size", po::value<size_t>(&size)->default_value(1024),
+      "Population size.")
+    ("rounds", po::value<size_t>(&rounds)->default_value(100),
+      "Generations to time.");
+
+  po::variables_map vm;
+  po::store(po::command_line_parser(argc, argv).options(desc).run(), vm);
+  po::notify(vm);
+
+  if (vm.count("help")) {
+    std::cout << desc << std::endl;
+    return 0;
+  }
+
+  const size_t n = ONEMAX_BITS;
+  const double rate = 1.0 / n;
+
+  using StringCandidate = pr::Candidate<std::string, double>;
+  using BitCandidate = pr::Candidate<Bits, double>;
+
+  pr::Random random(42);
+  pr::Population<StringCandidate> strings(size);
+  pr::Population<BitCandidate> bits(size);
+  for (size_t i = 0; i < size; i++) {
+    pr::RandomStream stream = random.stream(i);
+    pr::progeny(bits[i]) = Bits::random(stream);
+    pr::progeny(strings[i]) = pr::progeny(bits[i]).toString();
+    strings[i].alive = bits[i].alive = true;
+  }
+
+  std::cout << n << " bits, " << size << " candidates, " << rounds
+    << " generations" << std::endl;
+  std::cout << std::setw(12) << std::left << "encoding" << std::right
+    << std::setw(14) << "crossover [s]" << std::setw(14) << "flip [s]"
+    << std::setw(14) << "evaluate [s]" << std::setw(14) << "total [s]"
+    << std::endl;
+
+  report("string", run(strings, pr::Crossover<StringCandidate>(2),
+    StringFlip<StringCandidate>(rate),
+    pr::MismatchEvaluator<StringCandidate>(std::string(n, '1')), rounds));
+
+  report("bit string", run(bits, pr::Crossover<BitCandidate>(2),
+    pr::BitFlip<BitCandidate>(rate),
+    pr::HammingEvaluator<BitCandidate>(Bits::ones()), rounds));
+}
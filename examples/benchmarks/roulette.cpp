@@ -0,0 +1,93 @@
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <boost/program_options.hpp>
+
+#include <selectors/roulette_selector.h>
+
+namespace po = boost::program_options;
+
+using Candidate = pr::Candidate<int, double>;
+using Population = pr::Population<Candidate>;
+
+//! The previous RouletteSelector: the distribution is rebuilt after every
+//! pick, O(count N).
+void rebuildingSelect(Population& pop, size_t count, std::mt19937& mt) {
+  std::vector<double> weights(pop.size());
+  for (size_t i = 0; i < pop.size(); i++) {
+    weights[i] = pr::fitness(pop[i]);
+    pop[i].alive = false;
+  }
+
+  std::discrete_distribution<> dist(weights.begin(), weights.end());
+  for (size_t i = 0; i < count; i++) {
+    int idx = dist(mt);
+    weights[idx] = 0.0;
+    dist.param({ weights.begin(), weights.end() });
+    pop[idx].alive = true;
+  }
+}
+
+template <typename FType>
+double seconds(FType f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  std::chrono::duration<double> elapsed =
+    std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+int main(int argc, char** argv) {
+  size_t rebuild_limit;
+  size_t largest;
+  double share;
+
+  po::options_description desc("Recognized options");
+  desc.add_options()
+    ("help", "Print this help message.")
+    ("largest", po::value<size_t>(&largest)->default_value(10000000),
+      "Largest population.")
+    ("rebuild-limit", po::value<size_t>(&rebuild_limit)->default_value(100000),
+      "Largest population the rebuilding selector is run on.")
+    ("share", po::value<double>(&share)->default_value(0.1),
+      "Share of the population that survives.");
+
+  po::variables_map vm;
+  po::store(po::command_line_parser(argc, argv).options(desc).run(), vm);
+  po::notify(vm);
+
+  if (vm.count("help")) {
+    std::cout << desc << std::endl;
+    return 0;
+  }
+
+  std::mt19937 mt(42);
+  std::uniform_real_distribution<double> fitness(0.0, 1.0);
+
+  std::cout << std::setw(10) << "N" << std::setw(10) << "picks"
+    << std::setw(14) << "tree [s]" << std::setw(14) << "rebuild [s]"
+    << std::endl;
+
+  pr::RouletteSelector<Candidate> rs;
+  for (size_t n = 1000; n <= largest; n *= 10) {
+    Population pop(n);
+    for (size_t i = 0; i < n; i++) {
+      pop[i] = Candidate(static_cast<int>(i), fitness(mt));
+    }
+    size_t count = static_cast<size_t>(share * n);
+
+    double tree = seconds([&]{ rs.select(pop, count); });
+    std::cout << std::setw(10) << n << std::setw(10) << count
+      << std::setw(14) << std::fixed << std::setprecision(4) << tree;
+
+    if (n <= rebuild_limit) {
+      double rebuild = seconds([&]{ rebuildingSelect(pop, count, mt); });
+      std::cout << std::setw(14) << rebuild;
+    } else {
+      std::cout << std::setw(14) << "-";
+    }
+    std::cout << std::endl;
+  }
+}
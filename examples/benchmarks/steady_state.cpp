@@ -0,0 +1,216 @@
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+#include <array>
+#include <string>
+#include <random>
+#include <omp.h>
+#include <boost/program_options.hpp>
+
+#include <core/simulation.h>
+#include <evaluators/mismatch_evaluator.h>
+#include <evaluators/competitive_evaluator.h>
+#include <selectors/roulette_selector.h>
+#include <mutators/crossover.h>
+#include <generators/fill_generator.h>
+#include <mutators/pass_through.h>
+
+#ifndef QUEENS
+#define QUEENS 8
+#endif
+
+namespace po = boost::program_options;
+
+//! Records the latest progress report of the simulation it is bound to.
+template <typename CType>
+class Recorder : public pr::Observer<CType> {
+
+  using ProgressData = typename pr::Observer<CType>::ProgressData;
+
+  public:
+    ProgressData last;
+
+  protected:
+    void onProgress(const ProgressData& data) {
+      last = data;
+    }
+};
+
+struct Result {
+  size_t solved = 0;
+  size_t evaluations = 0;
+};
+
+//! Runs a simulation until a zero-error candidate shows up or the evaluation
+//! budget is exhausted, and returns the number of evaluations spent.
+template <typename Sim, typename CType>
+bool run(Sim& sim, bool steady, int size, int elites, size_t budget,
+    size_t& evaluations) {
+
+  using Population = pr::Population<CType>;
+
+  Recorder<CType> recorder;
+  recorder.bind(sim);
+
+  bool solved = false;
+  auto breakpoint = [&](const Population& pop, CType& elite) {
+    auto match = std::find_if(pop.begin(), pop.end(), [](const CType& c) {
+      return pr::fitness(c) == 0;
+    });
+
+    if (match != pop.end()) {
+      elite = *match;
+      solved = true;
+    }
+    return solved || recorder.last.evaluations >= budget;
+  };
+
+  if (steady) {
+    sim.evolveSteady(size, elites, breakpoint);
+  } else {
+    sim.evolve(size, elites, breakpoint);
+  }
+
+  evaluations = recorder.last.evaluations;
+  return solved;
+}
+
+Result wordguess(const std::string& target, bool steady, int size,
+    int elites, size_t budget, std::mt19937& mt) {
+
+  using Candidate = pr::Candidate<std::string, double>;
+
+  const char valid[] = "abcdefghijklmnopqrstuvwxyz";
+  std::uniform_int_distribution<int> dist(0, 25);
+
+  pr::FillGenerator<Candidate> fg([&]{
+    std::string str(target.size(), 0);
+    std::generate(str.begin(), str.end(), [&]{
+      return valid[dist(mt)];
+    });
+    return str;
+  });
+
+  pr::MismatchEvaluator<Candidate> mev(target);
+  pr::RouletteSelector<Candidate> rs;
+  auto mut = pr::Crossover<Candidate>(2) >> pr::PassThrough<Candidate>();
+  auto sim = pr::Simulation<Candidate>::build(fg, mev, rs, mut);
+
+  Result res;
+  res.solved = run<decltype(sim), Candidate>(
+    sim, steady, size, elites, budget, res.evaluations);
+  return res;
+}
+
+Result nqueens(bool steady, int size, int elites, size_t budget,
+    std::mt19937& mt) {
+
+  using Candidate = pr::Candidate<std::array<int, QUEENS>, int>;
+  using Population = pr::Population<Candidate>;
+  using PopItr = Population::iterator;
+
+  std::uniform_int_distribution<int> dist(0, QUEENS - 1);
+
+  pr::FillGenerator<Candidate> fg([&]{
+    std::array<int, QUEENS> board;
+    std::generate(board.begin(), board.end(), [&]{
+      return dist(mt);
+    });
+    return board;
+  });
+
+  pr::CompetitiveEvaluator<Candidate, 1> cev([](PopItr s, PopItr e){
+    const auto& board = pr::progeny(*s);
+
+    int attacks = 0;
+    for (int col = 0; col < QUEENS; col++) {
+      int pos = board[col];
+      for (int adv = col + 1; adv < QUEENS; adv++) {
+        if (board[adv] == pos || board[adv] == pos + (adv - col) ||
+            board[adv] == pos - (adv - col)) {
+          ++attacks;
+        }
+      }
+    }
+    pr::fitness(*s) = attacks;
+  });
+
+  pr::RouletteSelector<Candidate> rs;
+  auto mut = pr::Crossover<Candidate>(2) >> pr::PassThrough<Candidate>();
+  auto sim = pr::Simulation<Candidate>::build(fg, cev, rs, mut);
+
+  Result res;
+  res.solved = run<decltype(sim), Candidate>(
+    sim, steady, size, elites, budget, res.evaluations);
+  return res;
+}
+
+void report(const std::string& name, const std::vector<Result>& results) {
+  size_t solved = 0;
+  size_t evaluations = 0;
+  for (auto& r : results) {
+    solved += r.solved;
+    evaluations += r.evaluations;
+  }
+
+  std::cout << std::setw(24) << std::left << name
+    << std::setw(10) << std::right << solved << "/" << results.size()
+    << std::setw(16) << evaluations / results.size() << std::endl;
+}
+
+int main(int argc, char** argv) {
+  std::string target;
+  unsigned int size;
+  unsigned int elites;
+  unsigned int offspring;
+  unsigned int runs;
+  size_t budget;
+  unsigned int seed;
+
+  po::options_description desc("Recognized options");
+  desc.add_options()
+    ("help", "Print this help message.")
+    ("target", po::value<std::string>(&target)->default_value("progeny"),
+      "Target string for the wordguess workload.")
+    ("size", po::value<unsigned int>(&size)->default_value(200),
+      "Population size.")
+    ("elites", po::value<unsigned int>(&elites)->default_value(20),
+      "Survivors per generation in generational mode.")
+    ("offspring", po::value<unsigned int>(&offspring)->default_value(4),
+      "Replacements per step in steady-state mode.")
+    ("runs", po::value<unsigned int>(&runs)->default_value(10),
+      "Independent runs per configuration.")
+    ("budget", po::value<size_t>(&budget)->default_value(2000000),
+      "Evaluation budget after which a run is given up.")
+    ("seed", po::value<unsigned int>(&seed)->default_value(42),
+      "Seed for the RNG.");
+
+  po::variables_map vm;
+  po::store(po::command_line_parser(argc, argv).options(desc).run(), vm);
+  po::notify(vm);
+
+  if (vm.count("help")) {
+    std::cout << desc << std::endl;
+    return 0;
+  }
+
+  // The user lambdas share one engine, so keep them on a single thread.
+  omp_set_num_threads(1);
+  std::mt19937 mt(seed);
+
+  std::vector<Result> gen_word, steady_word, gen_queens, steady_queens;
+  for (unsigned int r = 0; r < runs; r++) {
+    gen_word.push_back(wordguess(target, false, size, elites, budget, mt));
+    steady_word.push_back(wordguess(target, true, size, offspring, budget, mt));
+    gen_queens.push_back(nqueens(false, size, elites, budget, mt));
+    steady_queens.push_back(nqueens(true, size, offspring, budget, mt));
+  }
+
+  std::cout << std::setw(24) << std::left << "workload"
+    << std::setw(12) << std::right << "solved"
+    << std::setw(16) << "evaluations" << std::endl;
+  report("wordguess/generational", gen_word);
+  report("wordguess/steady", steady_word);
+  report("nqueens/generational", gen_queens);
+  report("nqueens/steady", steady_queens);
+}
@@ -0,0 +1,95 @@
+#include <iostream>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <boost/mpi.hpp>
+#include <boost/program_options.hpp>
+#include <boost/serialization/string.hpp>
+
+#include <core/simulation.h>
+#include <core/distributed_simulation.h>
+#include <evaluators/mismatch_evaluator.h>
+#include <selectors/roulette_selector.h>
+#include <mutators/crossover.h>
+#include <generators/fill_generator.h>
+#include <mutators/point.h>
+
+namespace po = boost::program_options;
+namespace mpi = boost::mpi;
+
+// Usage: mpirun -np 4 ./distributed --target progeny
+int main(int argc, char** argv) {
+  mpi::environment env(argc, argv);
+  mpi::communicator world;
+
+  std::string target;
+  unsigned int size;
+  unsigned int interval;
+
+  po::options_description desc("Recognized options");
+  desc.add_options()
+    ("help", "Print this help message.")
+    ("target", po::value<std::string>(&target)->default_value("target"),
+      "Target string to evolve towards.")
+    ("size", po::value<unsigned int>(&size)->default_value(100),
+      "Population size on each rank.")
+    ("interval", po::value<unsigned int>(&interval)->default_value(5),
+      "Generations between migrations.");
+
+  po::variables_map vm;
+  po::store(po::command_line_parser(argc, argv).options(desc).run(), vm);
+  po::notify(vm);
+
+  if (vm.count("help")) {
+    if (world.rank() == 0) {
+      std::cout << desc << std::endl;
+    }
+    return 0;
+  }
+
+  using Candidate = pr::Candidate<std::string, double>;
+  using Population = pr::Population<Candidate>;
+
+  // DistributedSimulation forks the seed per rank, so every rank explores
+  // from different streams.
+  const char valid[] = "abcdefghijklmnopqrstuvwxyz";
+  pr::FillGenerator<Candidate> fg([&](pr::RandomStream& stream){
+    std::uniform_int_distribution<int> letter(0, 25);
+    std::string str(target.size(), 0);
+    std::generate(str.begin(), str.end(), [&]{
+      return valid[letter(stream)];
+    });
+    return str;
+  });
+
+  pr::MismatchEvaluator<Candidate> mev(target);
+  pr::RouletteSelector<Candidate> rs;
+  // Point mutation brings back letters the population has lost; crossover
+  // alone cannot.
+  std::vector<char> letters(valid, valid + 26);
+  auto mut = pr::Crossover<Candidate>(2) >> pr::Point<Candidate>(letters, 0.2);
+
+  pr::DistributedSimulation<
+    decltype(fg), decltype(mev), decltype(rs), decltype(mut), Candidate
+  > sim(world, fg, mev, rs, mut);
+  sim.migration(pr::Topology::Ring, interval, 2);
+
+  auto breakpoint = [](const Population& pop, Candidate& elite) {
+    auto match = std::find_if(pop.begin(), pop.end(), [](const Candidate& c){
+      return (pr::fitness(c) == 0.0);
+    });
+
+    if (match != std::end(pop)) {
+      elite = *match;
+      return true;
+    }
+    return false;
+  };
+
+  Candidate solution = sim.evolve(size, 10, breakpoint);
+
+  if (world.rank() == 0) {
+    std::cout << "Ranks: " << world.size() << ", solution: "
+      << pr::progeny(solution) << std::endl;
+  }
+}
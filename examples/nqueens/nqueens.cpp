@@ -1,8 +1,9 @@
 #include <iomanip>
 #include <iostream>
+#include <random>
 #include <algorithm>
 #include <core/simulation.h>
-#include <evaluators/competitive_evaluator.h>
+#include <evaluators/queens_evaluator.h>
 #include <selectors/roulette_selector.h>
 #include <mutators/crossover.h>
 #include <observers/terminal_observer.h>
@@ -17,42 +18,24 @@ int main(int argc, const char* argv[]) {
 
   using Candidate = pr::Candidate<std::array<int, QUEENS>, int>;
   using Population = pr::Population<Candidate>;
-  using PopItr = Population::iterator;
+  using ProgressData = pr::Simulation<Candidate>::ProgressData;
 
   std::cout << QUEENS << std::endl;
 
   // Construct Generator
-  pr::FillGenerator<Candidate> fg([]{
+  pr::FillGenerator<Candidate> fg([](pr::RandomStream& stream){
+    std::uniform_int_distribution<int> column(0, QUEENS - 1);
     std::array<int, QUEENS> board;
-    std::generate(board.begin(), board.end(), []{
-      return rand() % QUEENS;
+    std::generate(board.begin(), board.end(), [&]{
+      return column(stream);
     });
     return board;
   });
 
-  // Construct Evaluator
-  pr::CompetitiveEvaluator<Candidate, 1> cev([&](PopItr s, PopItr e){
-    auto board = pr::progeny(*s);
-
-    int attacks = 0;
-    for (int col = 0; col < QUEENS; col++) {
-      int pos = board[col];
-      for (int adv = col + 1; adv < QUEENS; adv++) {
-        if (board[adv] == pos) {
-          ++attacks;
-        }
-        
-        if (board[adv] == pos + (adv - col)) {
-          ++attacks;
-        }
-
-        if (board[adv] == pos - (adv - col)) {
-          ++attacks;
-        }
-      }
-    }
-    pr::fitness(*s) = attacks;
-  });
+  // Construct Evaluator. It counts the attacking pairs in O(QUEENS), and
+  // updates the count of a board whose crossover swapped only a few 
+  // columns from the columns that moved.
+  pr::QueensEvaluator<Candidate> qev;
 
   // Construct Selector
   pr::RouletteSelector<Candidate> rs;
@@ -61,20 +44,18 @@ int main(int argc, const char* argv[]) {
   auto mut = pr::Crossover<Candidate>(2) >> pr::PassThrough<Candidate>();
 
   // Finally, compose the simulator instance.
-  auto sim = pr::Simulation<Candidate>::build(fg, cev, rs, mut);
+  auto sim = pr::Simulation<Candidate>::build(fg, qev, rs, mut);
 
   // Create a breakpoint for our simulation run. This observes the population
   // after each iteration and decides if we have reached our termination
   // conditions. If so, the breakpoint should set the elite reference to the
-  // candidate that has satisfied the conditions. 
+  // candidate that has satisfied the conditions. The progress data already
+  // knows the fittest member, so there is no need to scan for it.
   // TODO: Multiple elites?
-  auto breakpoint = [](const Population& pop, Candidate& elite) {
-    auto match = std::find_if(pop.begin(), pop.end(), [](const Candidate& c){
-      return (pr::fitness(c) == 0.0);
-    });
-    
-    if (match != std::end(pop)) {
-      elite = *match;
+  auto breakpoint = [](const Population& pop, const ProgressData& data, 
+      Candidate& elite) {
+    if (data.minFitness == 0.0) {
+      elite = pop[data.bestIndex];
       return true;
     }
 
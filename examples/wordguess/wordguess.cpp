@@ -33,7 +33,7 @@ int main(int argc, char** argv) {
   po::store(po::command_line_parser(argc, argv).options(desc).run(), vm);
   po::notify(vm);
 
-  // Set up RNG.
+  // Set up RNG for the brute-force attempt.
   std::random_device rd;
   std::mt19937 mt(vm.count("seed") ? seed : rd());
   std::uniform_int_distribution<int> dist(0, 25);
@@ -44,10 +44,11 @@ int main(int argc, char** argv) {
   using Population = pr::Population<Candidate>;
 
   // Construct Generator
-  pr::FillGenerator<Candidate> fg([&]{
+  pr::FillGenerator<Candidate> fg([&](pr::RandomStream& stream){
+    std::uniform_int_distribution<int> letter(0, 25);
     std::string str(target.size(), 0);
     std::generate(str.begin(), str.end(), [&]{
-      return valid[dist(mt)];
+      return valid[letter(stream)];
     });
     return str;
   });
@@ -63,6 +64,9 @@ int main(int argc, char** argv) {
 
   // Finally, compose the simulator instance.
   auto sim = pr::Simulation<Candidate>::build(fg, mev, rs, mut);
+  if (vm.count("seed")) {
+    sim.seed(seed);
+  }
 
   // Create a breakpoint for our simulation run. This observes the population
   // after each iteration and decides if we have reached our termination
@@ -0,0 +1,213 @@
+#ifndef BIT_STRING_H
+#define BIT_STRING_H
+
+#include <array>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <type_traits>
+
+#include "random.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define PR_BIT_STRING_X86 1
+#endif
+
+namespace pr {
+
+  //! Population counts over word arrays.
+  /*!
+  *  Without -mpopcnt, __builtin_popcountll becomes a library call. The
+  *  loops are therefore compiled twice, once for the popcnt instruction,
+  *  and the right copy is picked on first use.
+  */
+  struct BitKernels {
+
+    //! Set bits of a[0, words), or of a ^ b if \p b is given.
+    using CountFn = size_t (*)(const uint64_t* a, const uint64_t* b,
+      size_t words);
+
+    static size_t portable(const uint64_t* a, const uint64_t* b,
+        size_t words) {
+      size_t bits = 0;
+      for (size_t w = 0; w < words; w++) {
+        bits += __builtin_popcountll(b ? a[w] ^ b[w] : a[w]);
+      }
+      return bits;
+    }
+
+#ifdef PR_BIT_STRING_X86
+    __attribute__((target("popcnt")))
+    static size_t popcnt(const uint64_t* a, const uint64_t* b,
+        size_t words) {
+      size_t bits = 0;
+      for (size_t w = 0; w < words; w++) {
+        bits += __builtin_popcountll(b ? a[w] ^ b[w] : a[w]);
+      }
+      return bits;
+    }
+#endif
+
+    static CountFn get() {
+#ifdef PR_BIT_STRING_X86
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("popcnt")) {
+        return &popcnt;
+      }
+#endif
+      return &portable;
+    }
+
+    static size_t count(const uint64_t* a, const uint64_t* b, size_t words) {
+      static const CountFn kernel = get();
+      return kernel(a, b, words);
+    }
+  };
+
+  //! Fixed-length string of N bits, packed 64 to a word.
+  /*!
+  *  Binary genomes stored as std::array<int, N> or std::string spend 8 to
+  *  32 bits on every bit of information. BitString keeps them packed, so
+  *  operators touch a word of 64 genes at a time: Crossover swaps masked
+  *  words, BitFlip XORs random masks and HammingEvaluator counts with
+  *  popcount.
+  *
+  *  Bit i lives in word i / 64 at position i % 64. The unused high bits of
+  *  the last word are kept zero, so that words compare and count as a
+  *  whole; code writing to words() directly has to preserve that.
+  *  \tparam N Number of bits.
+  */
+  template <size_t N>
+  class BitString {
+
+    static_assert(N > 0, "A bit string needs at least one bit.");
+
+    public:
+      using Word = uint64_t;
+
+      static const size_t WordBits = 64;
+      static const size_t Words = (N + WordBits - 1) / WordBits;
+
+    public:
+      //! All bits clear.
+      BitString() : m_words() {}
+
+      //! Parses a string of '0' and '1', bit 0 first. Missing bits are
+      //! clear and any other character sets its bit.
+      explicit BitString(const std::string& bits) : m_words() {
+        for (size_t i = 0; i < N && i < bits.size(); i++) {
+          set(i, bits[i] != '0');
+        }
+      }
+
+      //! All bits set, the optimum of OneMax.
+      static BitString ones() {
+        BitString b;
+        b.m_words.fill(~Word(0));
+        b.trim();
+        return b;
+      }
+
+      //! Uniformly random bits, e.g. for a FillGenerator.
+      static BitString random(RandomStream& stream) {
+        BitString b;
+        for (auto& w : b.m_words) {
+          w = static_cast<Word>(stream()) << 32 | stream();
+        }
+        b.trim();
+        return b;
+      }
+
+      static constexpr size_t size() { return N; }
+
+      bool test(size_t i) const {
+        return (m_words[i / WordBits] >> (i % WordBits)) & 1;
+      }
+
+      void set(size_t i, bool value = true) {
+        Word bit = Word(1) << (i % WordBits);
+        if (value) {
+          m_words[i / WordBits] |= bit;
+        } else {
+          m_words[i / WordBits] &= ~bit;
+        }
+      }
+
+      void flip(size_t i) {
+        m_words[i / WordBits] ^= Word(1) << (i % WordBits);
+      }
+
+      //! Number of set bits.
+      size_t count() const {
+        return BitKernels::count(m_words.data(), nullptr, Words);
+      }
+
+      //! Number of bits that differ from \p other.
+      size_t distance(const BitString& other) const {
+        return BitKernels::count(m_words.data(), other.m_words.data(), Words);
+      }
+
+      Word* words() { return m_words.data(); }
+      const Word* words() const { return m_words.data(); }
+
+      //! Bits of the last word that belong to the string.
+      static constexpr Word lastMask() {
+        return N % WordBits ? (Word(1) << (N % WordBits)) - 1 : ~Word(0);
+      }
+
+      //! Clears the unused bits of the last word.
+      void trim() {
+        m_words[Words - 1] &= lastMask();
+      }
+
+      BitString& operator^=(const BitString& other) {
+        for (size_t w = 0; w < Words; w++) {
+          m_words[w] ^= other.m_words[w];
+        }
+        return *this;
+      }
+
+      bool operator==(const BitString& other) const {
+        return m_words == other.m_words;
+      }
+
+      bool operator!=(const BitString& other) const {
+        return !(*this == other);
+      }
+
+      //! The bits as '0' and '1', bit 0 first.
+      std::string toString() const {
+        std::string s(N, '0');
+        for (size_t i = 0; i < N; i++) {
+          if (test(i)) {
+            s[i] = '1';
+          }
+        }
+        return s;
+      }
+
+      template <typename Archive>
+      void serialize(Archive& a, const unsigned int) {
+        for (auto& w : m_words) {
+          a & w;
+        }
+      }
+
+      friend std::ostream& operator<<(std::ostream& os, const BitString& b) {
+        return os << b.toString();
+      }
+
+    private:
+      std::array<Word, Words> m_words;
+  };
+
+  //! Failback for BitString detection.
+  template <typename T>
+  struct is_bit_string : std::false_type {};
+
+  template <size_t N>
+  struct is_bit_string<BitString<N>> : std::true_type {};
+}
+
+#endif
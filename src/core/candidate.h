@@ -4,6 +4,9 @@
 #include <utility>
 #include <type_traits>
 
+#include "objectives.h"
+#include "change_set.h"
+
 namespace pr {
 
   //! Encapsulates the basic population member type.
@@ -14,8 +17,8 @@ namespace pr {
   template <typename Base, typename Fitness>
   class Candidate : public std::pair<Base, Fitness> {
     
-    static_assert(std::is_arithmetic<Fitness>::value, 
-        "Fitness type must be arithmetic.");
+    static_assert(is_fitness<Fitness>::value, 
+        "Fitness type must be arithmetic or Objectives.");
 
     public:
       using BaseType = Base;
@@ -30,9 +33,36 @@ namespace pr {
 
     public:
       bool alive = true;
+      //! True while the fitness matches the progeny. Evaluators set it,
+      //! generators and mutators must clear it when they change the 
+      //! progeny (see Mutator::mutate()), and evaluators skip members 
+      //! that still have it.
+      bool valid = false;
+      //! The genes changed since the fitness was valid. Mutators record
+      //! what they overwrite with recordChange() or invalidate the set.
+      ChangeSet<Base> changes;
+      //! True while the fitness is a model's prediction rather than the
+      //! result of a real evaluation (see SurrogateEvaluator). Such a
+      //! fitness is never valid.
+      bool estimated = false;
 
   };
 
+  //! Records that gene \p index of \p cnd is about to be overwritten.
+  /*!
+  *  Call before writing the gene. If the fitness is still valid, it
+  *  becomes the base of a fresh change set; either way it is stale from
+  *  here on.
+  */
+  template <typename BType, typename FitType>
+  void recordChange(Candidate<BType, FitType>& cnd, size_t index) {
+    if (cnd.valid) {
+      cnd.changes.reset();
+      cnd.valid = false;
+    }
+    cnd.changes.record(index, std::get<0>(cnd)[index]);
+  }
+
   template <typename BType, typename FitType>
   FitType& fitness(Candidate<BType, FitType>& cnd) {
     return std::get<1>(cnd);
@@ -0,0 +1,119 @@
+#ifndef CHANGE_SET_H
+#define CHANGE_SET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#include "type_traits.h"
+
+namespace pr {
+
+  //! The genes a mutator changed since the fitness was last valid.
+  /*!
+  *  Every candidate carries one. A mutator that overwrites gene i records
+  *  the pair (i, old value) before writing (see recordChange()); one that
+  *  changes the progeny in any other way, or changes too many genes to
+  *  list, invalidates the set instead. While the set is tracked, the
+  *  fitness of the progeny before the recorded changes is the candidate's
+  *  fitness, so a DeltaEvaluator can update that fitness from the listed
+  *  genes alone instead of scoring the whole progeny again.
+  *
+  *  The set lives inside the candidate, so it holds at most Capacity
+  *  changes and overflows into the untracked state; a mutation that
+  *  changes more genes than that is not worth an incremental update.
+  *  Progeny types without indexable elements get an empty set that is
+  *  never tracked.
+  *  \tparam Base The progeny type.
+  */
+  template <typename Base, class Enable = void>
+  class ChangeSet {
+
+    public:
+      static const size_t Capacity = 0;
+
+      bool tracked() const { return false; }
+      size_t size() const { return 0; }
+      void reset() {}
+      void invalidate() {}
+  };
+
+  //! Change set for containers of indexable elements.
+  template <typename Base>
+  class ChangeSet<
+    Base,
+    typename std::enable_if<has_value_type<Base>::value>::type
+  > {
+
+    public:
+      using Value = typename Base::value_type;
+
+      struct Change {
+        uint32_t index;
+        Value old;
+      };
+
+      static const size_t Capacity = 4;
+
+    public:
+      //! Whether the listed changes are all there is since the fitness
+      //! was last valid.
+      bool tracked() const { return m_tracked; }
+
+      size_t size() const { return m_size; }
+
+      //! The changes in the order they were made.
+      const Change* begin() const { return m_changes; }
+      const Change* end() const { return m_changes + m_size; }
+      const Change& operator[](size_t k) const { return m_changes[k]; }
+
+      //! Value that the gene of change \p k held right after it.
+      /*!
+      *  That is the old value of the next change to the same gene, or the
+      *  gene's current value in \p progeny if there is none.
+      */
+      const Value& after(size_t k, const Base& progeny) const {
+        for (size_t l = k + 1; l < m_size; l++) {
+          if (m_changes[l].index == m_changes[k].index) {
+            return m_changes[l].old;
+          }
+        }
+        return progeny[m_changes[k].index];
+      }
+
+      //! Appends a change; overflows into the untracked state when full.
+      void record(size_t index, const Value& old) {
+        if (!m_tracked) {
+          return;
+        }
+        if (m_size == Capacity ||
+            index > std::numeric_limits<uint32_t>::max()) {
+          invalidate();
+          return;
+        }
+        m_changes[m_size].index = static_cast<uint32_t>(index);
+        m_changes[m_size].old = old;
+        m_size++;
+      }
+
+      //! Starts over from a fitness that matches the progeny.
+      void reset() {
+        m_size = 0;
+        m_tracked = true;
+      }
+
+      //! Forgets the changes; the next evaluation scores everything.
+      void invalidate() {
+        m_size = 0;
+        m_tracked = false;
+      }
+
+    private:
+      Change m_changes[Capacity];
+      uint8_t m_size = 0;
+      bool m_tracked = false;
+  };
+}
+
+#endif
@@ -0,0 +1,306 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "population.h"
+#include "serialization.h"
+
+namespace pr {
+
+  //! Snapshot of a simulation that can be written to and read from disk.
+  /*!
+  *  The file starts with a fixed header, followed by the operator state
+  *  blob, the fitness and flag blocks and finally the genomes. When the
+  *  progeny type is trivially copyable, the genomes form one raw block at a
+  *  cache-line aligned offset and read() maps the file instead of parsing
+  *  it. Other progeny types are encoded with BinaryCodec. The flag byte of
+  *  a member holds Alive, Valid and Estimated.
+  *  \tparam CType The candidate type of the simulation.
+  */
+  template <typename CType>
+  class Checkpoint {
+
+    using BaseType = typename CType::BaseType;
+    using FitnessType = typename CType::FitnessType;
+
+    static const bool Raw = std::is_trivially_copyable<BaseType>::value;
+    //! Raised whenever the layout or the meaning of a field changes, so
+    //! older readers reject newer files.
+    static const uint32_t Version = 1;
+
+    //! Bits of the per-member flag byte.
+    enum Flags : char { Alive = 1, Valid = 2, Estimated = 4 };
+
+    struct Header {
+      char magic[4];
+      uint32_t version;
+      uint32_t raw;
+      uint32_t genomeSize;
+      uint32_t fitnessSize;
+      uint64_t count;
+      uint64_t generation;
+      uint64_t evaluations;
+      double elapsedTime;
+      double meanFitness;
+      double fitnessVariance;
+      uint64_t stateSize;
+      uint64_t genomeOffset;
+    };
+
+    public:
+      uint64_t generation = 0;
+      uint64_t evaluations = 0;
+      double elapsedTime = 0.0;
+      double meanFitness = 0.0;
+      double fitnessVariance = 0.0;
+
+      //! Opaque operator state, see saveState() in serialization.h.
+      std::string state;
+      Population<CType> population;
+
+    public:
+      //! Writes the checkpoint to \p path.
+      /*!
+      *  The data goes to a temporary file that is renamed over \p path once
+      *  complete, so a crash mid-write never leaves a truncated checkpoint.
+      */
+      void write(const std::string& path) const {
+        std::string tmp = path + ".tmp";
+        {
+          std::ofstream os(tmp, std::ios::binary | std::ios::trunc);
+          if (!os) {
+            throw std::runtime_error("Cannot open checkpoint " + tmp);
+          }
+
+          Header hdr = header();
+          BinaryCodec<Header>::write(os, hdr);
+          os.write(state.data(), state.size());
+
+          for (auto& cnd : population) {
+            BinaryCodec<FitnessType>::write(os, pr::fitness(cnd));
+          }
+          for (auto& cnd : population) {
+            BinaryCodec<char>::write(os, 
+              (cnd.alive ? Alive : 0) | (cnd.valid ? Valid : 0) |
+              (cnd.estimated ? Estimated : 0));
+          }
+
+          pad(os, hdr.genomeOffset);
+          for (auto& cnd : population) {
+            BinaryCodec<BaseType>::write(os, pr::progeny(cnd));
+          }
+
+          if (!os) {
+            throw std::runtime_error("Failed writing checkpoint " + tmp);
+          }
+        }
+
+        if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+          throw std::runtime_error("Cannot replace checkpoint " + path);
+        }
+      }
+
+      //! Reads the checkpoint stored at \p path.
+      void read(const std::string& path) {
+        read(path, std::integral_constant<bool, Raw>());
+      }
+
+    private:
+      Header header() const {
+        Header hdr;
+        std::memset(&hdr, 0, sizeof(Header));
+        std::memcpy(hdr.magic, "PRCK", 4);
+        hdr.version = Version;
+        hdr.raw = Raw;
+        hdr.genomeSize = sizeof(BaseType);
+        hdr.fitnessSize = sizeof(FitnessType);
+        hdr.count = population.size();
+        hdr.generation = generation;
+        hdr.evaluations = evaluations;
+        hdr.elapsedTime = elapsedTime;
+        hdr.meanFitness = meanFitness;
+        hdr.fitnessVariance = fitnessVariance;
+        hdr.stateSize = state.size();
+
+        uint64_t end = sizeof(Header) + state.size() +
+          hdr.count * (sizeof(FitnessType) + 1);
+        hdr.genomeOffset = (end + 63) & ~uint64_t(63);
+        return hdr;
+      }
+
+      //! Whether \p count items of \p size bytes starting at \p offset
+      //! lie within the first \p length bytes, without overflowing.
+      static bool fits(uint64_t offset, uint64_t count, uint64_t size,
+          uint64_t length) {
+        return offset <= length && count <= (length - offset) / size;
+      }
+
+      //! Whether the state, fitness and flag blocks \p hdr describes lie
+      //! within a file of \p length bytes, in the order write() puts them,
+      //! and the genomes start after them.
+      static bool inside(const Header& hdr, uint64_t length) {
+        if (!fits(sizeof(Header), hdr.stateSize, 1, length)) {
+          return false;
+        }
+        uint64_t fitness = sizeof(Header) + hdr.stateSize;
+        if (!fits(fitness, hdr.count, sizeof(FitnessType), length)) {
+          return false;
+        }
+        uint64_t flags = fitness + hdr.count * sizeof(FitnessType);
+        return fits(flags, hdr.count, 1, length) &&
+          hdr.genomeOffset >= flags + hdr.count &&
+          hdr.genomeOffset <= length;
+      }
+
+      static void pad(std::ostream& os, uint64_t offset) {
+        while (static_cast<uint64_t>(os.tellp()) < offset) {
+          os.put(0);
+        }
+      }
+
+      void check(const Header& hdr, const std::string& path) const {
+        if (std::memcmp(hdr.magic, "PRCK", 4) != 0 ||
+            hdr.version != Version) {
+          throw std::runtime_error("Not a checkpoint: " + path);
+        }
+
+        if (hdr.raw != Raw || hdr.genomeSize != sizeof(BaseType) ||
+            hdr.fitnessSize != sizeof(FitnessType)) {
+          throw std::runtime_error("Checkpoint type mismatch: " + path);
+        }
+      }
+
+      void assign(const Header& hdr) {
+        generation = hdr.generation;
+        evaluations = hdr.evaluations;
+        elapsedTime = hdr.elapsedTime;
+        meanFitness = hdr.meanFitness;
+        fitnessVariance = hdr.fitnessVariance;
+      }
+
+      void read(const std::string& path, std::false_type) {
+        parse(path);
+      }
+
+      //! Copies the blocks straight out of a read-only mapping.
+      void read(const std::string& path, std::true_type) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+          throw std::runtime_error("Cannot open checkpoint " + path);
+        }
+
+        struct stat st;
+        if (::fstat(fd, &st) != 0 ||
+            static_cast<size_t>(st.st_size) < sizeof(Header)) {
+          ::close(fd);
+          throw std::runtime_error("Truncated checkpoint " + path);
+        }
+
+        size_t length = st.st_size;
+        void* addr = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED) {
+          throw std::runtime_error("Cannot map checkpoint " + path);
+        }
+
+        const char* base = static_cast<const char*>(addr);
+        Header hdr;
+        std::memcpy(&hdr, base, sizeof(Header));
+
+        try {
+          check(hdr, path);
+          if (!inside(hdr, length) || 
+              !fits(hdr.genomeOffset, hdr.count, sizeof(BaseType), length)) {
+            throw std::runtime_error("Truncated checkpoint " + path);
+          }
+        } catch (...) {
+          ::munmap(addr, length);
+          throw;
+        }
+
+        assign(hdr);
+        const char* cursor = base + sizeof(Header);
+        state.assign(cursor, hdr.stateSize);
+        cursor += hdr.stateSize;
+
+        const char* fitness = cursor;
+        const char* flags = fitness + hdr.count * sizeof(FitnessType);
+        const char* genomes = base + hdr.genomeOffset;
+
+        population.resize(hdr.count);
+        for (size_t i = 0; i < hdr.count; i++) {
+          std::memcpy(&pr::fitness(population[i]),
+            fitness + i * sizeof(FitnessType), sizeof(FitnessType));
+          std::memcpy(&pr::progeny(population[i]),
+            genomes + i * sizeof(BaseType), sizeof(BaseType));
+          population[i].alive = flags[i] & Alive;
+          population[i].valid = flags[i] & Valid;
+          population[i].estimated = flags[i] & Estimated;
+        }
+
+        ::munmap(addr, length);
+      }
+
+      //! Decodes the blocks with BinaryCodec.
+      /*!
+      *  Sizes from the header are checked against the file length before
+      *  anything is allocated. Encoded genomes vary in length, so only the
+      *  codec can tell whether they fit; it fails the stream rather than
+      *  allocating past the data that is actually there.
+      */
+      void parse(const std::string& path) {
+        std::ifstream is(path, std::ios::binary);
+        struct stat st;
+        if (!is || ::stat(path.c_str(), &st) != 0) {
+          throw std::runtime_error("Cannot open checkpoint " + path);
+        }
+
+        Header hdr;
+        BinaryCodec<Header>::read(is, hdr);
+        if (!is) {
+          throw std::runtime_error("Truncated checkpoint " + path);
+        }
+        check(hdr, path);
+        if (!inside(hdr, st.st_size)) {
+          throw std::runtime_error("Truncated checkpoint " + path);
+        }
+        assign(hdr);
+
+        state.resize(hdr.stateSize);
+        is.read(&state[0], hdr.stateSize);
+
+        population.resize(hdr.count);
+        for (auto& cnd : population) {
+          BinaryCodec<FitnessType>::read(is, pr::fitness(cnd));
+        }
+        for (auto& cnd : population) {
+          char flags;
+          BinaryCodec<char>::read(is, flags);
+          cnd.alive = flags & Alive;
+          cnd.valid = flags & Valid;
+          cnd.estimated = flags & Estimated;
+        }
+
+        is.seekg(hdr.genomeOffset);
+        for (auto& cnd : population) {
+          BinaryCodec<BaseType>::read(is, pr::progeny(cnd));
+        }
+
+        if (!is) {
+          throw std::runtime_error("Truncated checkpoint " + path);
+        }
+      }
+  };
+}
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef DELTA_EVALUATOR_H
+#define DELTA_EVALUATOR_H
+
+#include <vector>
+#include <omp.h>
+
+#include "evaluator.h"
+#include "candidate.h"
+#include "change_set.h"
+#include "type_traits.h"
+
+namespace pr {
+
+  //! Base class of evaluators that update a fitness incrementally.
+  /*!
+  *  A stale member whose change set is tracked and not empty had a valid
+  *  fitness before the listed genes changed, so its new fitness follows
+  *  from the previous one and the changes (see ChangeSet), which for
+  *  most problems costs a fraction of scoring the whole progeny. Any
+  *  other stale member is scored in full. Either way the member leaves
+  *  valid with an empty, tracked change set, the base for the next
+  *  mutation.
+  *
+  *  Descendants implement score() and delta(); evaluate() runs them in
+  *  parallel over the stale members.
+  *  \tparam CType The candidate type, whose progeny is a container of
+  *  indexable genes.
+  */
+  template <typename CType>
+  class DeltaEvaluator : public Evaluator<CType> {
+
+    public:
+      using Population = pr::Population<CType>;
+      using BaseType = typename CType::BaseType;
+      using FitnessType = typename CType::FitnessType;
+      using Changes = ChangeSet<BaseType>;
+
+      static_assert(has_value_type<BaseType>::value,
+          "DeltaEvaluator requires containers of indexable genes.");
+
+    public:
+      void evaluate(Population& pop) {
+        std::vector<size_t> indices = stale(pop);
+
+        #pragma omp parallel for schedule(dynamic, 64)
+        for (long k = 0; k < static_cast<long>(indices.size()); k++) {
+          update(pop[indices[k]]);
+        }
+      }
+
+      void evaluateRange(Population& pop, size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) {
+          if (!pop[i].valid) {
+            update(pop[i]);
+          }
+        }
+      }
+
+    protected:
+      //! The fitness of \p progeny, computed from scratch.
+      virtual FitnessType score(const BaseType& progeny) const = 0;
+
+      //! The fitness of \p progeny after \p changes, given the fitness
+      //! \p previous from before them.
+      virtual FitnessType delta(const BaseType& progeny,
+        FitnessType previous, const Changes& changes) const = 0;
+
+    private:
+      void update(CType& cnd) {
+        const BaseType& progeny = pr::progeny(cnd);
+        if (cnd.changes.tracked() && cnd.changes.size() > 0) {
+          pr::fitness(cnd) = delta(progeny, pr::fitness(cnd), cnd.changes);
+        } else {
+          pr::fitness(cnd) = score(progeny);
+        }
+        cnd.changes.reset();
+        cnd.valid = true;
+      }
+  };
+}
+
+#endif
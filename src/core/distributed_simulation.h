@@ -0,0 +1,274 @@
+#ifndef DISTRIBUTED_SIMULATION_H
+#define DISTRIBUTED_SIMULATION_H
+
+#include <vector>
+#include <list>
+#include <limits>
+#include <random>
+#include <numeric>
+#include <algorithm>
+#include <functional>
+#include <boost/mpi.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/serialization/utility.hpp>
+
+#include "simulation.h"
+#include "island_simulation.h"
+#include "utility.h"
+
+namespace pr {
+
+  //! Island-model driver distributed over MPI ranks.
+  /*!
+  *  Each rank owns one ProtoSimulation. Every few generations a rank sends
+  *  copies of its best members to a neighbour rank with non-blocking sends
+  *  and absorbs whatever migrants have arrived, without waiting for any.
+  *  Candidates travel through Boost.Serialization, so the progeny type needs
+  *  a serialization hook (see utility.h for tuples).
+  *
+  *  Termination is decided collectively at the same migration points: the
+  *  breakpoint runs on every rank's local population, the lowest rank that
+  *  satisfied it broadcasts its elite, and every rank returns that elite.
+  *  Run with e.g. `mpirun -np 4`.
+  *  \tparam GType The type of generator in use.
+  *  \tparam EType The type of evaluator in use.
+  *  \tparam SType The type of selector in use.
+  *  \tparam MType The type of mutator in use.
+  *  \tparam CType The type of candidate the simulation will operate on.
+  */
+  template <
+    typename GType,
+    typename EType,
+    typename SType,
+    typename MType,
+    typename CType
+  >
+  class DistributedSimulation {
+
+    using Candidate = CType;
+    using Local = ProtoSimulation<GType, EType, SType, MType, CType>;
+    using Population = typename pr::Population<CType>;
+    using Breakpoint = std::function<bool(const Population&, Candidate&)>;
+    using ProgressData = typename pr::Simulation<CType>::ProgressData;
+    using ProgressBreakpoint = std::function<
+      bool(const Population&, const ProgressData&, Candidate&)
+    >;
+    using Batch = std::vector<CType>;
+
+    static const int MigrantTag = 0x5052;
+    //! Fork of the rank's Random used for migration, see
+    //! IslandSimulation::Routes.
+    static const uint64_t Routes = 4;
+
+    public:
+      DistributedSimulation(boost::mpi::communicator comm,
+          GType g, EType e, SType s, MType m) :
+        m_comm(comm), m_local(std::move(g), std::move(e), std::move(s),
+          std::move(m)), m_topology(Topology::Ring), m_interval(10),
+        m_migrants(2) {
+        seed(0);
+      }
+
+      //! Seeds every rank with distinct, reproducible random streams.
+      /*!
+      *  Random migration draws from a fork of the rank's Random, keyed by
+      *  the generation, like IslandSimulation::seed.
+      */
+      void seed(uint64_t value) {
+        Random rank = Random(value).fork(m_comm.rank());
+        m_local.seed(rank);
+        m_routes = rank.fork(Routes);
+      }
+
+      DistributedSimulation(const DistributedSimulation&) = delete;
+      DistributedSimulation& operator=(const DistributedSimulation&) = delete;
+
+      //! Configures migration. See IslandSimulation::migration.
+      void migration(Topology topology, size_t interval, size_t migrants) {
+        m_topology = topology;
+        m_interval = std::max<size_t>(interval, 1);
+        m_migrants = migrants;
+      }
+
+      //! The simulation owned by this rank, e.g. to bind observers.
+      Local& local() { return m_local; }
+
+      //! Lowest fitness over all ranks as of the last migration point,
+      //! reduced to a scalar as the statistics are (see pr::scalar).
+      double globalBest() const { return m_global_best; }
+
+      //! Evolves every rank until one of them satisfies the breakpoint.
+      /*!
+      *  Must be called collectively by every rank of the communicator.
+      *  \returns The elite found by the lowest satisfying rank.
+      */
+      Candidate evolve(int size, int elites, Breakpoint bp) {
+        std::vector<size_t> sent(m_comm.size(), 0);
+        size_t received = 0;
+
+        bool done = false;
+        Candidate elite;
+
+        ProgressBreakpoint rank_bp = [&](const Population& pop,
+            const ProgressData& data, Candidate& out) {
+          if (!done) {
+            done = bp(pop, elite);
+          }
+
+          if (data.generation % m_interval != 0) {
+            return false;
+          }
+
+          emigrate(pop, data.generation, sent);
+          received += immigrate();
+          collect();
+
+          // Agree on the lowest rank that is done, if any.
+          int mine = done ? m_comm.rank() : m_comm.size();
+          int first = boost::mpi::all_reduce(m_comm, mine,
+            boost::mpi::minimum<int>());
+
+          m_global_best = boost::mpi::all_reduce(m_comm, best(pop),
+            boost::mpi::minimum<double>());
+
+          if (first == m_comm.size()) {
+            return false;
+          }
+
+          boost::mpi::broadcast(m_comm, elite, first);
+          out = elite;
+          return true;
+        };
+
+        Candidate result = m_local.evolve(size, elites, rank_bp);
+        drain(sent, received);
+        return result;
+      }
+
+    private:
+      static double best(const Population& pop) {
+        double fit = std::numeric_limits<double>::infinity();
+        for (auto& cnd : pop) {
+          fit = std::min(fit, pr::scalar(pr::fitness(cnd)));
+        }
+        return fit;
+      }
+
+      void emigrate(const Population& pop, size_t generation,
+          std::vector<size_t>& sent) {
+        int ranks = m_comm.size();
+        if (ranks < 2 || m_migrants == 0) {
+          return;
+        }
+
+        size_t count = std::min(m_migrants, pop.size());
+        std::vector<size_t> order(pop.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::partial_sort(order.begin(), order.begin() + count, order.end(),
+          [&pop](size_t a, size_t b) {
+            return pr::scalar(pr::fitness(pop[a])) < 
+              pr::scalar(pr::fitness(pop[b]));
+          });
+
+        Batch batch;
+        for (size_t i = 0; i < count; i++) {
+          batch.push_back(pop[order[i]]);
+        }
+
+        int rank = m_comm.rank();
+        switch (m_topology) {
+          case Topology::Ring:
+            send((rank + 1) % ranks, batch, sent);
+            break;
+
+          case Topology::FullyConnected:
+            for (int r = 0; r < ranks; r++) {
+              if (r != rank) {
+                send(r, batch, sent);
+              }
+            }
+            break;
+
+          case Topology::Random: {
+            RandomStream stream = m_routes.stream(generation);
+            std::uniform_int_distribution<int> dist(1, ranks - 1);
+            send((rank + dist(stream)) % ranks, batch, sent);
+            break;
+          }
+        }
+      }
+
+      void send(int dest, const Batch& batch, std::vector<size_t>& sent) {
+        m_outbox.emplace_back();
+        m_outbox.back().second = batch;
+        m_outbox.back().first = m_comm.isend(dest, MigrantTag,
+          m_outbox.back().second);
+        sent[dest]++;
+      }
+
+      //! Receives every migrant batch that has already arrived.
+      size_t immigrate() {
+        size_t count = 0;
+        Population arrivals;
+        while (auto status = m_comm.iprobe(boost::mpi::any_source,
+            MigrantTag)) {
+          Batch batch;
+          m_comm.recv(status->source(), MigrantTag, batch);
+          std::move(batch.begin(), batch.end(),
+            std::back_inserter(arrivals));
+          count++;
+        }
+
+        if (!arrivals.empty()) {
+          m_local.immigrate(arrivals);
+        }
+        return count;
+      }
+
+      //! Releases the buffers of sends that have completed.
+      void collect() {
+        for (auto it = m_outbox.begin(); it != m_outbox.end();) {
+          if (it->first.test()) {
+            it = m_outbox.erase(it);
+          } else {
+            ++it;
+          }
+        }
+      }
+
+      //! Completes outstanding traffic so no message outlives the run.
+      void drain(const std::vector<size_t>& sent, size_t received) {
+        std::vector<size_t> incoming;
+        boost::mpi::all_to_all(m_comm, sent, incoming);
+        size_t expected = std::accumulate(incoming.begin(), incoming.end(),
+          size_t(0));
+
+        while (received < expected || !m_outbox.empty()) {
+          while (received < expected) {
+            auto status = m_comm.iprobe(boost::mpi::any_source, MigrantTag);
+            if (!status) {
+              break;
+            }
+            Batch batch;
+            m_comm.recv(status->source(), MigrantTag, batch);
+            received++;
+          }
+          collect();
+        }
+      }
+
+    private:
+      boost::mpi::communicator m_comm;
+      Local m_local;
+      Random m_routes;
+
+      Topology m_topology;
+      size_t m_interval;
+      size_t m_migrants;
+
+      std::list<std::pair<boost::mpi::request, Batch>> m_outbox;
+      double m_global_best = 0.0;
+  };
+}
+
+#endif
@@ -2,8 +2,14 @@
 #define EVALUATOR_H
 
 #include <type_traits>
+#include <iterator>
+#include <algorithm>
+#include <vector>
+#include <limits>
 
+#include "population.h"
 #include "type_traits.h"
+#include "../util/cache_stats.h"
 
 namespace pr {
 
@@ -34,12 +40,166 @@ namespace pr {
       *  each member of the population, will be passed by reference to this 
       *  function. The function should retrieve the base-type, evaluate its 
       *  fitness,then assign that fitness to the candidate.
+      *
+      *  Evaluators may skip the members whose fitness is still valid (see
+      *  Candidate::valid and stale()) and set the flag on the ones they
+      *  evaluate. Those that leave the flag alone evaluate everybody.
       *  \param mbr The population member to be evaluated.
       */
       virtual void evaluate(Population&) = 0;
+
+      //! Evaluates the members in [first, last) of the given population.
+      /*!
+      *  Used by the asynchronous pipeline, which calls it concurrently on
+      *  disjoint ranges from several worker threads. The default moves the 
+      *  range into a scratch population and back; evaluators that can work
+      *  in place should override it with a serial loop.
+      */
+      virtual void evaluateRange(Population& pop, size_t first, size_t last) {
+        Population slice;
+        slice.reserve(last - first);
+        std::move(pop.begin() + first, pop.begin() + last, 
+          std::back_inserter(slice));
+        evaluate(slice);
+        std::move(slice.begin(), slice.end(), pop.begin() + first);
+      }
+
       virtual bool isNatural() { return true; }
   };
 
+  //! Indices of the members in [first, last) whose fitness is stale.
+  /*!
+  *  Evaluators loop over this compacted list instead of the population,
+  *  so a parallel loop over it stays balanced however the stale members
+  *  are scattered.
+  */
+  template <typename CType>
+  std::vector<size_t> stale(const Population<CType>& pop, size_t first,
+      size_t last) {
+    std::vector<size_t> indices;
+    for (size_t i = first; i < last; i++) {
+      if (!pop[i].valid) {
+        indices.push_back(i);
+      }
+    }
+    return indices;
+  }
+
+  template <typename CType>
+  std::vector<size_t> stale(const Population<CType>& pop) {
+    return stale(pop, 0, pop.size());
+  }
+
+  //! Number of members in [first, last) whose fitness is stale.
+  template <typename CType>
+  size_t countStale(const Population<CType>& pop, size_t first, 
+      size_t last) {
+    return std::count_if(pop.begin() + first, pop.begin() + last,
+      [](const CType& cnd) { return !cnd.valid; });
+  }
+
+  template <typename CType>
+  size_t countStale(const Population<CType>& pop) {
+    return countStale(pop, 0, pop.size());
+  }
+
+  //! Failure specialization.
+  template <typename T, typename = void>
+  struct has_cache_stats : std::false_type {};
+
+  //! Detects evaluators that remember fitness values, such as
+  //! CachingEvaluator.
+  template <typename T>
+  struct has_cache_stats<T, typename type_void<
+    decltype(std::declval<const T&>().cacheStats())
+  >::type> : std::true_type {};
+
+  template <typename T>
+  typename std::enable_if<has_cache_stats<T>::value, CacheStats>::type
+  cacheStats(const T& evaluator) {
+    return evaluator.cacheStats();
+  }
+
+  template <typename T>
+  typename std::enable_if<!has_cache_stats<T>::value, CacheStats>::type
+  cacheStats(const T&) {
+    return CacheStats();
+  }
+
+  //! Work an evaluator saved by abandoning hopeless candidates early.
+  struct RaceStats {
+    //! Members evaluated since the evaluator was built.
+    size_t evaluations = 0;
+    //! Those of them abandoned part way through.
+    size_t aborted = 0;
+    //! Evaluation work skipped, in whole evaluations.
+    double savedWork = 0.0;
+    //! The rejection threshold currently in force.
+    double threshold = std::numeric_limits<double>::infinity();
+  };
+
+  //! Failure specialization.
+  template <typename T, typename = void>
+  struct has_race_stats : std::false_type {};
+
+  //! Detects evaluators that accept a rejection threshold, such as
+  //! RacingEvaluator.
+  template <typename T>
+  struct has_race_stats<T, typename type_void<
+    decltype(std::declval<const T&>().raceStats(),
+      std::declval<T&>().threshold(0.0))
+  >::type> : std::true_type {};
+
+  template <typename T>
+  typename std::enable_if<has_race_stats<T>::value, RaceStats>::type
+  raceStats(const T& evaluator) {
+    return evaluator.raceStats();
+  }
+
+  template <typename T>
+  typename std::enable_if<!has_race_stats<T>::value, RaceStats>::type
+  raceStats(const T&) {
+    return RaceStats();
+  }
+
+  //! Publishes the fitness beyond which a candidate cannot survive.
+  template <typename T>
+  typename std::enable_if<has_race_stats<T>::value>::type
+  threshold(T& evaluator, double value) {
+    evaluator.threshold(value);
+  }
+
+  template <typename T>
+  typename std::enable_if<!has_race_stats<T>::value>::type
+  threshold(T&, double) {}
+
+  //! Failure specialization.
+  template <typename T, typename = void>
+  struct has_next_generation : std::false_type {};
+
+  //! Detects evaluators that keep state from one generation to the next,
+  //! such as the tournament rounds of CompetitiveEvaluator.
+  template <typename T>
+  struct has_next_generation<T, typename type_void<
+    decltype(std::declval<T&>().nextGeneration())
+  >::type> : std::true_type {};
+
+  //! Moves the evaluator on once every range of a generation is evaluated.
+  /*!
+  *  evaluate() does this itself. Concurrent evaluateRange() calls only
+  *  read the per-generation state, so whoever splits the population into
+  *  ranges calls this after the last of them has returned.
+  */
+  template <typename T>
+  typename std::enable_if<has_next_generation<T>::value>::type
+  nextGeneration(T& evaluator) {
+    evaluator.nextGeneration();
+  }
+
+  template <typename T>
+  typename std::enable_if<!has_next_generation<T>::value>::type
+  nextGeneration(T&) {}
+
 }
 
 #endif
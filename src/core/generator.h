@@ -4,6 +4,8 @@
 #include <functional>
 #include <vector>
 #include <random>
+#include <iterator>
+#include <algorithm>
 
 #include "population.h"
 
@@ -28,6 +30,20 @@ namespace pr {
       Generator() = default;
       virtual ~Generator() = default; 
       virtual void generate(Population&) = 0;
+
+      //! Generates the dead members in [first, last) of the population.
+      /*!
+      *  The default moves the range into a scratch population and back; 
+      *  generators that can work in place should override it.
+      */
+      virtual void generateRange(Population& pop, size_t first, size_t last) {
+        Population slice;
+        slice.reserve(last - first);
+        std::move(pop.begin() + first, pop.begin() + last, 
+          std::back_inserter(slice));
+        generate(slice);
+        std::move(slice.begin(), slice.end(), pop.begin() + first);
+      }
   };
 }
 
@@ -0,0 +1,241 @@
+#ifndef ISLAND_SIMULATION_H
+#define ISLAND_SIMULATION_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <random>
+#include <algorithm>
+#include <numeric>
+#include <functional>
+#include <omp.h>
+
+#include "simulation.h"
+#include "../util/mailbox.h"
+
+namespace pr {
+
+  //! Shape of the migration graph between islands.
+  enum class Topology {
+    Ring,           //!< Island k sends to island k + 1.
+    FullyConnected, //!< Every island sends to every other island.
+    Random          //!< Each migration picks one other island at random.
+  };
+
+  //! Island-model driver running several populations concurrently.
+  /*!
+  *  Every island is a full ProtoSimulation with its own copy of the
+  *  operators, evolved on its own thread. Every few generations an island
+  *  posts copies of its best members to its neighbours' mailboxes and
+  *  absorbs whatever migrants have arrived in its own, replacing its worst
+  *  members. Mailboxes are lock-free, so islands never wait on each other.
+  *
+  *  Observers bind to individual islands through island(). Their callbacks
+  *  fire on that island's thread. The breakpoint is shared by all islands
+  *  and may therefore be called concurrently.
+  *  \tparam GType The type of generator in use.
+  *  \tparam EType The type of evaluator in use.
+  *  \tparam SType The type of selector in use.
+  *  \tparam MType The type of mutator in use.
+  *  \tparam CType The type of candidate the simulation will operate on.
+  */
+  template <
+    typename GType,
+    typename EType,
+    typename SType,
+    typename MType,
+    typename CType
+  >
+  class IslandSimulation {
+
+    //! Fork of an island's Random used for migration, after the four
+    //! its operators get.
+    static const uint64_t Routes = 4;
+
+    using Candidate = CType;
+    using Island = ProtoSimulation<GType, EType, SType, MType, CType>;
+    using Population = typename pr::Population<CType>;
+    using Breakpoint = std::function<bool(const Population&, Candidate&)>;
+    using ProgressData = typename pr::Simulation<CType>::ProgressData;
+    using ProgressBreakpoint = std::function<
+      bool(const Population&, const ProgressData&, Candidate&)
+    >;
+
+    public:
+      IslandSimulation(size_t islands, GType g, EType e, SType s, MType m) :
+        m_mailboxes(islands), m_routes(islands), m_topology(Topology::Ring),
+        m_interval(10), m_migrants(2), m_threads(1) {
+
+        m_islands.reserve(islands);
+        for (size_t k = 0; k < islands; k++) {
+          m_islands.emplace_back(g, e, s, m);
+        }
+        seed(0);
+      }
+
+      //! Seeds the islands with distinct, reproducible random streams.
+      /*!
+      *  Random migration draws from a fork of each island's Random as
+      *  well, keyed by the island's generation, so the routes follow the
+      *  seed rather than the order in which threads get scheduled.
+      */
+      void seed(uint64_t value) {
+        Random root(value);
+        for (size_t k = 0; k < m_islands.size(); k++) {
+          Random island = root.fork(k);
+          m_islands[k].seed(island);
+          m_routes[k] = island.fork(Routes);
+        }
+      }
+
+      IslandSimulation(const IslandSimulation&) = delete;
+      IslandSimulation& operator=(const IslandSimulation&) = delete;
+
+      //! Configures migration.
+      /*!
+      *  \param topology The migration graph.
+      *  \param interval Generations between two migrations.
+      *  \param migrants Number of best members sent per neighbour.
+      */
+      void migration(Topology topology, size_t interval, size_t migrants) {
+        m_topology = topology;
+        m_interval = std::max<size_t>(interval, 1);
+        m_migrants = migrants;
+      }
+
+      //! Sets the OpenMP team size used inside each island.
+      void threadsPerIsland(int threads) {
+        m_threads = threads;
+      }
+
+      size_t size() const { return m_islands.size(); }
+
+      Island& island(size_t k) { return m_islands[k]; }
+
+      //! Evolves all islands until one of them satisfies the breakpoint.
+      /*!
+      *  \param size Population size of each island.
+      *  \param elites Survivors per generation on each island.
+      *  \param bp Termination test, shared by all islands.
+      *  \returns The elite of the first island to satisfy \p bp.
+      */
+      Candidate evolve(int size, int elites, Breakpoint bp) {
+        m_stop = false;
+
+        // Migrants posted after their island's last receive of an earlier
+        // run belong to that run's populations.
+        for (auto& box : m_mailboxes) {
+          box.clear();
+        }
+
+        std::vector<std::thread> workers;
+        for (size_t k = 0; k < m_islands.size(); k++) {
+          workers.emplace_back(&IslandSimulation::run, this, k, size,
+            elites, std::ref(bp));
+        }
+
+        for (auto& w : workers) {
+          w.join();
+        }
+        return m_elite;
+      }
+
+    private:
+      void run(size_t k, int size, int elites, Breakpoint& bp) {
+        omp_set_num_threads(m_threads);
+
+        Population arrivals;
+
+        ProgressBreakpoint island_bp = [&](const Population& pop,
+            const ProgressData& data, Candidate& elite) {
+          if (m_stop.load(std::memory_order_relaxed)) {
+            return true;
+          }
+
+          if (bp(pop, elite)) {
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (!m_stop.exchange(true)) {
+              m_elite = elite;
+            }
+            return true;
+          }
+
+          if (data.generation % m_interval == 0) {
+            emigrate(k, pop, data.generation);
+          }
+
+          arrivals.clear();
+          m_mailboxes[k].receive([&](Population&& batch) {
+            std::move(batch.begin(), batch.end(),
+              std::back_inserter(arrivals));
+          });
+          if (!arrivals.empty()) {
+            m_islands[k].immigrate(arrivals);
+          }
+          return false;
+        };
+
+        m_islands[k].evolve(size, elites, island_bp);
+      }
+
+      void emigrate(size_t k, const Population& pop, size_t generation) {
+        size_t islands = m_islands.size();
+        if (islands < 2 || m_migrants == 0) {
+          return;
+        }
+
+        // Lowest error first; only the head of the order is sorted.
+        size_t count = std::min(m_migrants, pop.size());
+        std::vector<size_t> order(pop.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::partial_sort(order.begin(), order.begin() + count, order.end(),
+          [&pop](size_t a, size_t b) {
+            return pr::scalar(pr::fitness(pop[a])) < 
+              pr::scalar(pr::fitness(pop[b]));
+          });
+
+        Population best;
+        for (size_t i = 0; i < count; i++) {
+          best.push_back(pop[order[i]]);
+        }
+
+        switch (m_topology) {
+          case Topology::Ring:
+            m_mailboxes[(k + 1) % islands].post(std::move(best));
+            break;
+
+          case Topology::FullyConnected:
+            for (size_t j = 0; j < islands; j++) {
+              if (j != k) {
+                m_mailboxes[j].post(best);
+              }
+            }
+            break;
+
+          case Topology::Random: {
+            RandomStream stream = m_routes[k].stream(generation);
+            std::uniform_int_distribution<size_t> dist(1, islands - 1);
+            m_mailboxes[(k + dist(stream)) % islands].post(std::move(best));
+            break;
+          }
+        }
+      }
+
+    private:
+      std::vector<Island> m_islands;
+      std::vector<Mailbox<Population>> m_mailboxes;
+      std::vector<Random> m_routes;
+
+      Topology m_topology;
+      size_t m_interval;
+      size_t m_migrants;
+      int m_threads;
+
+      std::atomic<bool> m_stop;
+      std::mutex m_lock;
+      Candidate m_elite;
+  };
+}
+
+#endif
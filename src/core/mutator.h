@@ -6,10 +6,14 @@
 #include <vector>
 #include <functional>
 #include <tuple> 
+#include <iterator>
+#include <algorithm>
 
 #include "candidate.h"
 #include "population.h"
 #include "type_traits.h"
+#include "serialization.h"
+#include "random.h"
 
 namespace pr {
 
@@ -34,17 +38,119 @@ namespace pr {
 
       /*!
       *  Mutates the provided population in place. 
+      *
+      *  Every member whose progeny changes must have its `valid` flag
+      *  cleared, or its old fitness is kept and it is never evaluated
+      *  again. Its change set must either list the overwritten genes,
+      *  via recordChange() before each write, or be invalidated, so that
+      *  a DeltaEvaluator does not update the fitness from a stale list.
       *  \param p The population to operate on.
       *  \returns The population, after mutation.
       */
       virtual void mutate(Population&) = 0;
+
+      //! Mutates the members in [first, last) of the given population.
+      /*!
+      *  Used by Split, which runs several mutators concurrently on 
+      *  disjoint ranges. The default moves the range into a scratch 
+      *  population and back; mutators that can work in place should 
+      *  override it with a serial loop. Overrides clear `valid` and
+      *  maintain the change sets as mutate() does.
+      */
+      virtual void mutateRange(Population& pop, size_t first, size_t last) {
+        Population slice;
+        slice.reserve(last - first);
+        std::move(pop.begin() + first, pop.begin() + last, 
+          std::back_inserter(slice));
+        mutate(slice);
+        std::move(slice.begin(), slice.end(), pop.begin() + first);
+      }
+  };
+
+  //! Failure specialization.
+  template <typename T, typename = void>
+  struct is_elementwise : std::false_type {};
+
+  //! Detects mutators that transform each candidate independently.
+  /*!
+  *  Such mutators provide `void apply(Candidate&)`, which mutate() calls 
+  *  for every living member of the population. A pipeline of element-wise 
+  *  stages can then visit each candidate once and run all stages on it 
+  *  while it is still in cache.
+  */
+  template <typename T>
+  struct is_elementwise<T, typename type_void<
+    decltype(std::declval<T&>().apply(
+      std::declval<typename T::Candidate&>()))
+  >::type> : std::true_type {};
+
+  //! Tail of a fused pipeline that does nothing.
+  struct NoTail {
+    template <typename CType>
+    void operator()(CType&) const {}
   };
 
+  //! Failure specialization.
+  template <typename T, typename = void>
+  struct is_fusable : std::false_type {};
+
+  //! Detects operators that can run a trailing element-wise stage inline.
+  template <typename T>
+  struct is_fusable<T, typename type_void<
+    decltype(std::declval<T&>().mutateThen(
+      std::declval<typename T::Population&>(), NoTail()))
+  >::type> : std::true_type {};
+
+  //! Runs \p op on \p pop, then \p tail on every living member.
+  /*!
+  *  Overloads pick the cheapest way to do so: pipelines forward the tail 
+  *  inward, element-wise operators apply it in the same loop and anything
+  *  else runs staged, followed by one pass for the tail.
+  */
+  template <typename OpType, typename Tail>
+  typename std::enable_if<is_fusable<OpType>::value>::type
+  mutateThen(OpType& op, typename OpType::Population& pop, Tail tail) {
+    op.mutateThen(pop, tail);
+  }
+
+  template <typename OpType, typename Tail>
+  typename std::enable_if<
+    !is_fusable<OpType>::value && is_elementwise<OpType>::value
+  >::type mutateThen(OpType& op, typename OpType::Population& pop, Tail tail) {
+    for (auto& cnd : pop) {
+      if (cnd.alive) {
+        op.apply(cnd);
+        tail(cnd);
+      }
+    }
+  }
+
+  template <typename OpType, typename Tail>
+  typename std::enable_if<
+    !is_fusable<OpType>::value && !is_elementwise<OpType>::value
+  >::type mutateThen(OpType& op, typename OpType::Population& pop, Tail tail) {
+    op.mutate(pop);
+    if (std::is_same<Tail, NoTail>::value) {
+      return;
+    }
+
+    for (auto& cnd : pop) {
+      if (cnd.alive) {
+        tail(cnd);
+      }
+    }
+  }
+
   //! Encapsulated series of evolutionary operators.
   /*!
   *  This class encapsulates a series of evolutionary operators 
   *  and provides syntax sugar for easily and fluently constructing 
   *  evolutionary pipelines from constituent operations.
+  *
+  *  Runs of element-wise stages are fused at compile time: instead of 
+  *  walking the population once per stage, each living candidate passes 
+  *  through all of them in one visit. Stages that work on the population 
+  *  as a whole, like Crossover, split the pipeline and run staged.
   *  \tparam CType The candidate type that this pipeline operates on.
   *  \tparam OType The type of the outer mutator.
   *  \tparam IType The type of the inner mutator.
@@ -52,15 +158,82 @@ namespace pr {
   template <typename CType, typename IType, typename OType>
   class Pipeline : public Mutator<CType> {
 
-    using typename Mutator<CType>::Candidate;
-    using typename Mutator<CType>::Population;
+    public:
+      using typename Mutator<CType>::Candidate;
+      using typename Mutator<CType>::Population;
 
     public:
       Pipeline(IType i, OType o) : m_inner(i), m_outer(o) {};
 
       void mutate(Population& pop) {
-        m_inner.mutate(pop);
-        m_outer.mutate(pop);
+        mutateThen(pop, NoTail());
+      }
+
+      void mutateRange(Population& pop, size_t first, size_t last) {
+        stage(pop, first, last, 
+          std::integral_constant<bool, is_elementwise<Pipeline>::value>());
+      }
+
+      //! Runs the pipeline, then \p tail on each living candidate.
+      template <typename Tail>
+      void mutateThen(Population& pop, Tail tail) {
+        fuse(pop, tail, is_elementwise<OType>());
+      }
+
+      //! Applies both stages to one candidate, if both are element-wise.
+      template <typename I = IType, typename O = OType>
+      typename std::enable_if<
+        is_elementwise<I>::value && is_elementwise<O>::value
+      >::type apply(Candidate& cnd) {
+        m_inner.apply(cnd);
+        m_outer.apply(cnd);
+      }
+
+      void seed(const Random& random) {
+        pr::seed(m_inner, random.fork(0));
+        pr::seed(m_outer, random.fork(1));
+      }
+
+      void saveState(std::ostream& os) const {
+        pr::saveState(m_inner, os);
+        os << ' ';
+        pr::saveState(m_outer, os);
+      }
+
+      void loadState(std::istream& is) {
+        pr::loadState(m_inner, is);
+        pr::loadState(m_outer, is);
+      }
+
+    private:
+      void stage(Population& pop, size_t first, size_t last, std::true_type) {
+        for (size_t i = first; i < last; i++) {
+          if (pop[i].alive) {
+            apply(pop[i]);
+          }
+        }
+      }
+
+      void stage(Population& pop, size_t first, size_t last, std::false_type) {
+        m_inner.mutateRange(pop, first, last);
+        m_outer.mutateRange(pop, first, last);
+      }
+
+      //! The outer stage joins the tail and runs inside the inner loop.
+      template <typename Tail>
+      void fuse(Population& pop, Tail tail, std::true_type) {
+        OType& outer = m_outer;
+        pr::mutateThen(m_inner, pop, [&outer, &tail](Candidate& cnd) {
+          outer.apply(cnd);
+          tail(cnd);
+        });
+      }
+
+      //! The outer stage needs the whole population, so this is a barrier.
+      template <typename Tail>
+      void fuse(Population& pop, Tail tail, std::false_type) {
+        pr::mutateThen(m_inner, pop, NoTail());
+        pr::mutateThen(m_outer, pop, tail);
       }
 
     protected:
@@ -68,17 +241,13 @@ namespace pr {
       OType m_outer;
   };
 
-  template <
-    typename CType, 
-    template <typename...> class IType, 
-    template <typename...> class OType
-  >
+  template <typename IType, typename OType>
   typename std::enable_if<
-    std::is_base_of<Mutator<CType>, IType<CType>>::value &&
-    std::is_base_of<Mutator<CType>, OType<CType>>::value,
-    Pipeline<CType, IType<CType>, OType<CType>>
-  >::type operator>>(const IType<CType>& i, const OType<CType>& o) {
-    return std::move(Pipeline<CType, IType<CType>, OType<CType>>(i, o));
+    std::is_base_of<Mutator<typename IType::Candidate>, IType>::value &&
+    std::is_base_of<Mutator<typename IType::Candidate>, OType>::value,
+    Pipeline<typename IType::Candidate, IType, OType>
+  >::type operator>>(const IType& i, const OType& o) {
+    return Pipeline<typename IType::Candidate, IType, OType>(i, o);
   }
 }
 
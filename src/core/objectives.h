@@ -0,0 +1,100 @@
+#ifndef OBJECTIVES_H
+#define OBJECTIVES_H
+
+#include <array>
+#include <algorithm>
+#include <initializer_list>
+#include <cstddef>
+#include <type_traits>
+
+namespace pr {
+
+  //! Vector-valued fitness for problems with several competing objectives.
+  /*!
+  *  Every component is an error measure in its own right, so lower is
+  *  better in each. Two candidates are compared by Pareto dominance (see
+  *  dominates()) rather than by a single number; selectors that do not
+  *  understand dominance, and the statistics, fall back on scalar().
+  *  \tparam T Arithmetic type of each objective.
+  *  \tparam M Number of objectives.
+  */
+  template <typename T, size_t M>
+  struct Objectives : std::array<T, M> {
+
+    static_assert(std::is_arithmetic<T>::value,
+        "Objective type must be arithmetic.");
+    static_assert(M > 0, "At least one objective is required.");
+
+    static const size_t Count = M;
+
+    Objectives() : std::array<T, M>() {}
+
+    //! Missing trailing objectives are zero.
+    Objectives(std::initializer_list<T> values) : std::array<T, M>() {
+      std::copy_n(values.begin(), std::min(values.size(), M), 
+        this->begin());
+    }
+
+    template <typename Archive>
+    void serialize(Archive& a, const unsigned int) {
+      for (auto& v : *this) {
+        a & v;
+      }
+    }
+  };
+
+  //! Failback for Objectives detection.
+  template <typename T>
+  struct is_objectives : std::false_type {};
+
+  template <typename T, size_t M>
+  struct is_objectives<Objectives<T, M>> : std::true_type {};
+
+  //! Tests whether a type may be used as the fitness of a Candidate.
+  template <typename T>
+  struct is_fitness : std::integral_constant<bool,
+    std::is_arithmetic<T>::value || is_objectives<T>::value> {};
+
+  //! Number of objectives of a fitness type.
+  template <typename T, typename = void>
+  struct objective_count : std::integral_constant<size_t, 1> {};
+
+  template <typename T>
+  struct objective_count<T,
+    typename std::enable_if<is_objectives<T>::value>::type
+  > : std::integral_constant<size_t, T::Count> {};
+
+  //! Scalar view of a fitness, used for statistics and elitism.
+  template <typename T>
+  typename std::enable_if<std::is_arithmetic<T>::value, double>::type
+  scalar(const T& fitness) {
+    return static_cast<double>(fitness);
+  }
+
+  //! The sum of the objectives. A member minimizing the sum is never
+  //! dominated, so the "best" member reported this way is Pareto-optimal.
+  template <typename T, size_t M>
+  double scalar(const Objectives<T, M>& fitness) {
+    double sum = 0.0;
+    for (auto& v : fitness) {
+      sum += static_cast<double>(v);
+    }
+    return sum;
+  }
+
+  //! True if \p a is no worse than \p b in every objective and strictly
+  //! better in at least one.
+  template <typename T, size_t M>
+  bool dominates(const Objectives<T, M>& a, const Objectives<T, M>& b) {
+    bool better = false;
+    for (size_t m = 0; m < M; m++) {
+      if (b[m] < a[m]) {
+        return false;
+      }
+      better = better || a[m] < b[m];
+    }
+    return better;
+  }
+}
+
+#endif
@@ -2,6 +2,7 @@
 #define OBSERVER_H
 
 #include <boost/signals2.hpp>
+#include <boost/bind.hpp>
 
 #include "simulation.h"
 
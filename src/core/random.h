@@ -0,0 +1,233 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <array>
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <type_traits>
+
+#include "type_traits.h"
+
+namespace pr {
+
+  //! The Philox-4x32-10 counter-based bijection.
+  /*!
+  *  Maps a 128-bit counter and a 64-bit key to 128 random bits with ten
+  *  rounds of multiply-xor mixing (Salmon et al., "Parallel random numbers:
+  *  as easy as 1, 2, 3"). There is no hidden state: any block of the
+  *  sequence can be computed directly from its counter, which is what
+  *  makes streams independent of the order and the thread they run on.
+  */
+  struct Philox {
+    using Counter = std::array<uint32_t, 4>;
+    using Key = std::array<uint32_t, 2>;
+
+    static Counter block(Counter ctr, Key key) {
+      for (int r = 0; r < 10; r++) {
+        uint64_t p0 = static_cast<uint64_t>(0xD2511F53u) * ctr[0];
+        uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57u) * ctr[2];
+
+        ctr = Counter{{
+          static_cast<uint32_t>(p1 >> 32) ^ ctr[1] ^ key[0],
+          static_cast<uint32_t>(p1),
+          static_cast<uint32_t>(p0 >> 32) ^ ctr[3] ^ key[1],
+          static_cast<uint32_t>(p0)
+        }};
+
+        key[0] += 0x9E3779B9u;
+        key[1] += 0xBB67AE85u;
+      }
+      return ctr;
+    }
+  };
+
+  //! One independent sequence of random numbers.
+  /*!
+  *  Satisfies UniformRandomBitGenerator, so it plugs into the standard
+  *  distributions. Its whole state is a key, a stream id, an epoch and a
+  *  position, so it is cheap to create one per candidate inside a
+  *  parallel loop.
+  */
+  class RandomStream {
+
+    public:
+      using result_type = uint32_t;
+
+    public:
+      RandomStream() : RandomStream(Philox::Key{{0, 0}}, 0, 0) {}
+
+      RandomStream(Philox::Key key, uint32_t epoch, uint64_t id) :
+        m_key(key), m_counter{{0, epoch, static_cast<uint32_t>(id),
+          static_cast<uint32_t>(id >> 32)}}, m_index(4) {}
+
+      static constexpr result_type min() {
+        return 0;
+      }
+
+      static constexpr result_type max() {
+        return std::numeric_limits<result_type>::max();
+      }
+
+      result_type operator()() {
+        if (m_index == 4) {
+          m_block = Philox::block(m_counter, m_key);
+          m_counter[0]++;
+          m_index = 0;
+        }
+        return m_block[m_index++];
+      }
+
+      //! Uniform double in [0, 1) with 53 random bits.
+      double uniform() {
+        uint32_t a = (*this)() >> 5;
+        uint32_t b = (*this)() >> 6;
+        return (a * 67108864.0 + b) / 9007199254740992.0;
+      }
+
+      friend std::ostream& operator<<(std::ostream& os,
+          const RandomStream& s) {
+        os << s.m_key[0] << ' ' << s.m_key[1];
+        for (auto c : s.m_counter) {
+          os << ' ' << c;
+        }
+        return os << ' ' << s.m_index;
+      }
+
+      friend std::istream& operator>>(std::istream& is, RandomStream& s) {
+        is >> s.m_key[0] >> s.m_key[1];
+        for (auto& c : s.m_counter) {
+          is >> c;
+        }
+        is >> s.m_index;
+
+        // The buffered block is a function of the counter, so recompute it.
+        if (s.m_index < 4) {
+          Philox::Counter prev = s.m_counter;
+          prev[0]--;
+          s.m_block = Philox::block(prev, s.m_key);
+        }
+        return is;
+      }
+
+    private:
+      Philox::Key m_key;
+      Philox::Counter m_counter;
+      Philox::Counter m_block;
+      uint32_t m_index;
+  };
+
+  //! Seeded source of random streams for one operator.
+  /*!
+  *  Operators draw a stream per candidate, keyed by the candidate's index
+  *  rather than by the thread that happens to process it, so results are
+  *  identical for any number of threads. Calling next() between uses,
+  *  typically once per generation, moves to a fresh set of streams. A
+  *  simulation seeds every operator with its own fork() of one Random.
+  */
+  class Random {
+
+    public:
+      Random(uint64_t seed = 0) : m_key{{static_cast<uint32_t>(seed),
+        static_cast<uint32_t>(seed >> 32)}}, m_epoch(0) {}
+
+      //! An independent Random for the \p k-th child of this one.
+      Random fork(uint64_t k) const {
+        auto bits = Philox::block(Philox::Counter{{
+          static_cast<uint32_t>(k), static_cast<uint32_t>(k >> 32),
+          m_epoch, 0x6b6579u
+        }}, m_key);
+
+        Random child;
+        child.m_key = Philox::Key{{bits[0], bits[1]}};
+        return child;
+      }
+
+      //! The stream with the given id in the current epoch.
+      RandomStream stream(uint64_t id) const {
+        return RandomStream(m_key, m_epoch, id);
+      }
+
+      //! Moves on to a fresh set of streams.
+      void next() {
+        m_epoch++;
+      }
+
+      uint32_t epoch() const {
+        return m_epoch;
+      }
+
+      //! Fills [first, last) with uniform doubles in [0, 1) in bulk.
+      /*!
+      *  Each Philox block yields two values and block j always lands at
+      *  offset 2j, so large buffers are split across threads without
+      *  changing the output.
+      *  \param id Stream id, distinct from ids used elsewhere this epoch.
+      */
+      void uniform(double* first, double* last, uint64_t id) const {
+        long count = last - first;
+        long blocks = (count + 1) / 2;
+
+        #pragma omp parallel for schedule(static) if(blocks > Parallel)
+        for (long j = 0; j < blocks; j++) {
+          auto bits = Philox::block(Philox::Counter{{
+            static_cast<uint32_t>(j), m_epoch, static_cast<uint32_t>(id),
+            static_cast<uint32_t>(id >> 32) ^ 0x80000000u
+          }}, m_key);
+
+          first[2 * j] = toDouble(bits[0], bits[1]);
+          if (2 * j + 1 < count) {
+            first[2 * j + 1] = toDouble(bits[2], bits[3]);
+          }
+        }
+      }
+
+      void uniform(std::vector<double>& out, uint64_t id) const {
+        uniform(out.data(), out.data() + out.size(), id);
+      }
+
+      void saveState(std::ostream& os) const {
+        os << m_key[0] << ' ' << m_key[1] << ' ' << m_epoch;
+      }
+
+      void loadState(std::istream& is) {
+        is >> m_key[0] >> m_key[1] >> m_epoch;
+      }
+
+    private:
+      // Blocks below which a bulk fill is not worth starting threads for.
+      static const long Parallel = 4096;
+
+      static double toDouble(uint32_t a, uint32_t b) {
+        return ((a >> 5) * 67108864.0 + (b >> 6)) / 9007199254740992.0;
+      }
+
+    private:
+      Philox::Key m_key;
+      uint32_t m_epoch;
+  };
+
+  //! Failure specialization.
+  template <typename T, typename = void>
+  struct has_seed : std::false_type {};
+
+  //! Detects operators that draw from the shared RNG service.
+  template <typename T>
+  struct has_seed<T, typename type_void<
+    decltype(std::declval<T&>().seed(std::declval<const Random&>()))
+  >::type> : std::true_type {};
+
+  template <typename T>
+  typename std::enable_if<has_seed<T>::value>::type
+  seed(T& op, const Random& random) {
+    op.seed(random);
+  }
+
+  template <typename T>
+  typename std::enable_if<!has_seed<T>::value>::type
+  seed(T&, const Random&) {}
+}
+
+#endif
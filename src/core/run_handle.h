@@ -0,0 +1,90 @@
+#ifndef RUN_HANDLE_H
+#define RUN_HANDLE_H
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <future>
+#include <chrono>
+
+#include "../util/cancellation.h"
+
+namespace pr {
+
+  //! Handle to a simulation running in the background.
+  /*!
+  *  Returned by evolveAsync(). Besides waiting for the result, it exposes
+  *  the best candidate of the latest completed generation and lets the
+  *  caller cancel the run, which then stops within one pipeline stage and
+  *  yields the best candidate it has seen.
+  *  \tparam CType The candidate type of the simulation.
+  */
+  template <typename CType>
+  class RunHandle {
+
+    public:
+      //! Progress shared between the run and its handle.
+      struct State {
+        State() : token(CancellationToken::create()), generation(0) {}
+
+        void publish(const CType& candidate, size_t gen) {
+          std::lock_guard<std::mutex> lock(mutex);
+          best = candidate;
+          generation = gen;
+        }
+
+        CancellationToken token;
+        std::mutex mutex;
+        CType best;
+        std::atomic<size_t> generation;
+      };
+
+    public:
+      RunHandle(std::shared_ptr<State> state, std::future<CType> result) :
+        m_state(std::move(state)), m_result(std::move(result)) {}
+
+      RunHandle(RunHandle&&) = default;
+      RunHandle& operator=(RunHandle&&) = default;
+
+      //! Asks the run to stop at its next check.
+      void cancel() {
+        m_state->token.cancel();
+      }
+
+      bool cancelled() const {
+        return m_state->token.cancelled();
+      }
+
+      //! Best candidate of the latest completed generation.
+      CType best() const {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        return m_state->best;
+      }
+
+      //! Number of completed generations.
+      size_t generation() const {
+        return m_state->generation;
+      }
+
+      //! True once the result is available.
+      bool ready() const {
+        return m_result.wait_for(std::chrono::seconds(0)) ==
+          std::future_status::ready;
+      }
+
+      void wait() const {
+        m_result.wait();
+      }
+
+      //! Waits for the run and returns its elite; rethrows its errors.
+      CType get() {
+        return m_result.get();
+      }
+
+    private:
+      std::shared_ptr<State> m_state;
+      std::future<CType> m_result;
+  };
+}
+
+#endif
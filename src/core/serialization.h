@@ -0,0 +1,192 @@
+#ifndef SERIALIZATION_H
+#define SERIALIZATION_H
+
+#include <tuple>
+#include <algorithm>
+#include <array>
+#include <string>
+#include <vector>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <cstdint>
+#include <type_traits>
+
+#include "type_traits.h"
+
+namespace pr {
+
+  //! Compact binary encoding of progeny and fitness values.
+  /*!
+  *  Trivially copyable types are written as raw bytes. Strings and vectors
+  *  are length-prefixed; tuples and arrays of non-trivial types are written
+  *  element-wise. The encoding is native-endian and meant for checkpoints
+  *  read back on the same platform, not for interchange.
+  */
+  template <typename T, class Enable = void>
+  struct BinaryCodec;
+
+  //! Elements a length-prefixed read allocates ahead of the data.
+  /*!
+  *  Length prefixes come from the stream and may be corrupt, so strings
+  *  and vectors grow with the data actually read, a chunk at a time. A
+  *  bogus length then fails the stream at its end instead of allocating
+  *  whatever the prefix claims.
+  */
+  const size_t CodecChunk = 4096;
+
+  template <typename T>
+  struct BinaryCodec<
+    T,
+    typename std::enable_if<std::is_trivially_copyable<T>::value>::type
+  > {
+    static void write(std::ostream& os, const T& t) {
+      os.write(reinterpret_cast<const char*>(&t), sizeof(T));
+    }
+
+    static void read(std::istream& is, T& t) {
+      is.read(reinterpret_cast<char*>(&t), sizeof(T));
+    }
+  };
+
+  template <typename C>
+  struct BinaryCodec<std::basic_string<C>> {
+    static void write(std::ostream& os, const std::basic_string<C>& s) {
+      BinaryCodec<uint64_t>::write(os, s.size());
+      os.write(reinterpret_cast<const char*>(s.data()), s.size() * sizeof(C));
+    }
+
+    static void read(std::istream& is, std::basic_string<C>& s) {
+      uint64_t size;
+      BinaryCodec<uint64_t>::read(is, size);
+      s.clear();
+      while (is && s.size() < size) {
+        size_t at = s.size();
+        s.resize(at + std::min<uint64_t>(size - at, CodecChunk));
+        is.read(reinterpret_cast<char*>(&s[at]), (s.size() - at) * sizeof(C));
+      }
+    }
+  };
+
+  template <typename T>
+  struct BinaryCodec<std::vector<T>> {
+    static void write(std::ostream& os, const std::vector<T>& v) {
+      BinaryCodec<uint64_t>::write(os, v.size());
+      for (auto& t : v) {
+        BinaryCodec<T>::write(os, t);
+      }
+    }
+
+    static void read(std::istream& is, std::vector<T>& v) {
+      uint64_t size;
+      BinaryCodec<uint64_t>::read(is, size);
+      v.clear();
+      if (is) {
+        v.reserve(std::min<uint64_t>(size, CodecChunk));
+      }
+      while (is && v.size() < size) {
+        v.emplace_back();
+        BinaryCodec<T>::read(is, v.back());
+      }
+    }
+  };
+
+  template <typename T, size_t N>
+  struct BinaryCodec<
+    std::array<T, N>,
+    typename std::enable_if<!std::is_trivially_copyable<T>::value>::type
+  > {
+    static void write(std::ostream& os, const std::array<T, N>& a) {
+      for (auto& t : a) {
+        BinaryCodec<T>::write(os, t);
+      }
+    }
+
+    static void read(std::istream& is, std::array<T, N>& a) {
+      for (auto& t : a) {
+        BinaryCodec<T>::read(is, t);
+      }
+    }
+  };
+
+  template <size_t X>
+  struct TupleCodec {
+    template <typename... Ts>
+    static void write(std::ostream& os, const std::tuple<Ts...>& t) {
+      TupleCodec<X - 1>::write(os, t);
+      using E = typename std::tuple_element<X - 1, std::tuple<Ts...>>::type;
+      BinaryCodec<E>::write(os, std::get<X - 1>(t));
+    }
+
+    template <typename... Ts>
+    static void read(std::istream& is, std::tuple<Ts...>& t) {
+      TupleCodec<X - 1>::read(is, t);
+      using E = typename std::tuple_element<X - 1, std::tuple<Ts...>>::type;
+      BinaryCodec<E>::read(is, std::get<X - 1>(t));
+    }
+  };
+
+  template <>
+  struct TupleCodec<0> {
+    template <typename... Ts>
+    static void write(std::ostream&, const std::tuple<Ts...>&) {}
+
+    template <typename... Ts>
+    static void read(std::istream&, std::tuple<Ts...>&) {}
+  };
+
+  template <typename... Ts>
+  struct BinaryCodec<
+    std::tuple<Ts...>,
+    typename std::enable_if<
+      !std::is_trivially_copyable<std::tuple<Ts...>>::value
+    >::type
+  > {
+    static void write(std::ostream& os, const std::tuple<Ts...>& t) {
+      TupleCodec<sizeof...(Ts)>::write(os, t);
+    }
+
+    static void read(std::istream& is, std::tuple<Ts...>& t) {
+      TupleCodec<sizeof...(Ts)>::read(is, t);
+    }
+  };
+
+  //! Failure specialization.
+  template <typename T, typename = void>
+  struct has_state : std::false_type {};
+
+  //! Detects operators that can save and restore their internal state.
+  /*!
+  *  Operators opt into checkpointing by providing
+  *  `void saveState(std::ostream&) const` and
+  *  `void loadState(std::istream&)`, typically for their RNG engines.
+  */
+  template <typename T>
+  struct has_state<T, typename type_void<
+    decltype(std::declval<const T&>().saveState(std::declval<std::ostream&>()))
+  >::type> : std::true_type {};
+
+  template <typename T>
+  typename std::enable_if<has_state<T>::value>::type
+  saveState(const T& op, std::ostream& os) {
+    op.saveState(os);
+  }
+
+  template <typename T>
+  typename std::enable_if<!has_state<T>::value>::type
+  saveState(const T&, std::ostream&) {}
+
+  template <typename T>
+  typename std::enable_if<has_state<T>::value>::type
+  loadState(T& op, std::istream& is) {
+    // Engine extractors switch the stream to std::ios::dec, which clears
+    // skipws, so the separators written by saveState() are consumed here.
+    op.loadState(is >> std::ws);
+  }
+
+  template <typename T>
+  typename std::enable_if<!has_state<T>::value>::type
+  loadState(T&, std::istream&) {}
+}
+
+#endif
@@ -3,14 +3,34 @@
 
 #include <thread>
 #include <condition_variable>
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <sstream>
+#include <exception>
+#include <future>
+#include <omp.h>
 #include <boost/signals2.hpp>
 #include <chrono>
+#include <memory>
+#include <numeric>
+#include <algorithm>
+#include <cmath>
 
 #include "generator.h"
 #include "evaluator.h"
 #include "observer.h"
 #include "selector.h"
 #include "mutator.h"
+#include "checkpoint.h"
+#include "serialization.h"
+#include "statistics.h"
+#include "timing.h"
+#include "run_handle.h"
+#include "random.h"
+#include "../util/bounded_queue.h"
+#include "../util/cancellation.h"
+#include "../util/thread_pool.h"
 
 namespace pr {
 
@@ -23,6 +43,15 @@ namespace pr {
   >
   class ProtoSimulation;
 
+  template <
+    typename GType, 
+    typename EType, 
+    typename SType, 
+    typename MType, 
+    typename CType
+  >
+  class IslandSimulation;
+
   template <typename CType>
   class Simulation {
     friend class Observer<CType>;
@@ -33,8 +62,29 @@ namespace pr {
         size_t generation = 0;
         double meanFitness = 0.0;
         double fitnessVariance = 0.0;
+        double minFitness = 0.0;
+        double maxFitness = 0.0;
+        //! Index of the fittest (lowest fitness) member of the population.
+        size_t bestIndex = 0;
         CType bestCandidate;
+        //! Fitness counts over [minFitness, maxFitness], see histogram().
+        std::vector<size_t> histogram;
         double elapsedTime = 0.0;
+        size_t evaluations = 0;
+        //! Time spent in each stage during the last generation.
+        StageTimes stageTimes;
+        //! Evaluation throughput of the last generation's evaluate stage.
+        double evaluationsPerSecond = 0.0;
+        //! Busy/idle split of the statistics threads, by OpenMP thread id.
+        std::vector<ThreadTime> threadTimes;
+        //! Busy/idle split of the asynchronous evaluation workers, if any.
+        std::vector<ThreadTime> workerTimes;
+        //! Lookups of a caching evaluator since it was built; all zero for
+        //! evaluators without a cache.
+        CacheStats cache;
+        //! Work a racing evaluator saved since it was built, see racing();
+        //! all zero for other evaluators.
+        RaceStats racing;
       } ProgressData;
 
     public:
@@ -69,6 +119,25 @@ namespace pr {
         return ProtoSimulation<GType, EType, SType, MType, CType>(g, e, s, m);
       }
 
+      template <
+        typename GType, 
+        typename EType, 
+        typename SType, 
+        typename MType
+      >
+      static typename std::enable_if<
+        std::is_base_of<typename pr::Generator<CType>, GType>::value &&
+        std::is_base_of<typename pr::Evaluator<CType>, EType>::value &&
+        std::is_base_of<typename pr::Selector<CType>, SType>::value &&
+        std::is_base_of<typename pr::Mutator<CType>, MType>::value,
+        std::unique_ptr<IslandSimulation<GType, EType, SType, MType, CType>>
+      >::type buildIslands(size_t islands, GType g, EType e, SType s, MType m) {
+        return std::unique_ptr<
+          IslandSimulation<GType, EType, SType, MType, CType>
+        >(new IslandSimulation<GType, EType, SType, MType, CType>(
+          islands, g, e, s, m));
+      }
+
   };
 
   
@@ -101,6 +170,9 @@ namespace pr {
     using Population = typename pr::Population<CType>;
     using Breakpoint = std::function<bool(const Population&, Candidate&)>;
     using ProgressData = typename pr::Simulation<Candidate>::ProgressData;
+    using ProgressBreakpoint = std::function<
+      bool(const Population&, const ProgressData&, Candidate&)
+    >;
 
     public:
       //! Constructor for Simulation.
@@ -114,7 +186,11 @@ namespace pr {
       */
       ProtoSimulation(Generator g, Evaluator e, Selector s, Mutator p) :
         m_generator(std::move(g)), m_evaluator(std::move(e)), 
-        m_selector(std::move(s)), m_pipeline(std::move(p)) {}
+        m_selector(std::move(s)), m_pipeline(std::move(p)), 
+        m_async_workers(0), m_async_chunk(16), m_checkpoint_every(0),
+        m_histogram_bins(0), m_race_quantile(0.0), m_step_elites(0) {
+        seed(0);
+      }
 
       ProtoSimulation(ProtoSimulation&& otr) = default;
       ProtoSimulation& operator=(ProtoSimulation&&) = default;
@@ -125,7 +201,14 @@ namespace pr {
       //! Destructor for Simulation.
       ~ProtoSimulation() {}
 
-      Candidate evolve(int size, int elites, Breakpoint bp) {
+      //! Runs the simulation until the breakpoint is satisfied.
+      /*!
+      *  This overload hands the breakpoint the statistics of the current
+      *  generation as well, so it can look at ProgressData::bestIndex or 
+      *  ProgressData::minFitness instead of scanning the population again.
+      */
+      Candidate evolve(int size, int elites, ProgressBreakpoint bp) {
+        m_stepping.reset();
 
         ProgressData obs_data;
         auto start_time = std::chrono::high_resolution_clock::now();
@@ -133,55 +216,711 @@ namespace pr {
         // Preallocate a population.
         m_population.resize(size);
 
+        AsyncScope async(*this);
+        obs_data.evaluations += refresh(m_population, obs_data);
+        publishThreshold();
+
+        return run(elites, bp, obs_data, start_time);
+      }
+
+      Candidate evolve(int size, int elites, Breakpoint bp) {
+        return evolve(size, elites, adapt(bp));
+      }
+
+      Candidate evolve(int size, int elites, Population& seed, 
+          ProgressBreakpoint bp) {
+        m_population = seed;
+        return std::move(evolve(size, elites, bp));
+      }
+
+      Candidate evolve(int size, int elites, Population& seed, Breakpoint bp) {
+        return evolve(size, elites, seed, adapt(bp));
+      }
+
+      //! Continues a run from a checkpoint written by this simulation.
+      /*!
+      *  Restores the population, the progress counters and the state of 
+      *  every operator that supports saveState()/loadState(), then carries 
+      *  on as evolve() would have. With deterministic operators the resumed 
+      *  run is bit-identical to the uninterrupted one.
+      *  \param path The checkpoint file.
+      *  \param elites Survivors per generation.
+      *  \param bp The breakpoint checked after every generation.
+      */
+      Candidate resume(const std::string& path, int elites, 
+          ProgressBreakpoint bp) {
+        m_stepping.reset();
+
+        Checkpoint<Candidate> cp;
+        cp.read(path);
+
+        m_population = std::move(cp.population);
+        loadStates(cp.state);
+        publishThreshold();
+
+        ProgressData obs_data;
+        obs_data.generation = cp.generation;
+        obs_data.evaluations = cp.evaluations;
+        obs_data.meanFitness = cp.meanFitness;
+        obs_data.fitnessVariance = cp.fitnessVariance;
+        obs_data.elapsedTime = cp.elapsedTime;
+
+        auto start_time = Clock::now() - 
+          std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(cp.elapsedTime));
+
+        AsyncScope async(*this);
+        return run(elites, bp, obs_data, start_time);
+      }
+
+      Candidate resume(const std::string& path, int elites, Breakpoint bp) {
+        return resume(path, elites, adapt(bp));
+      }
+
+      //! Starts evolve() on a thread of its own and returns immediately.
+      /*!
+      *  The handle reports the best candidate after every generation and
+      *  can cancel the run, which is checked between pipeline stages; a
+      *  cancelled run yields the best candidate of its last complete 
+      *  generation. The simulation must outlive the run and must not be 
+      *  used by anyone else in the meantime.
+      */
+      RunHandle<Candidate> evolveAsync(int size, int elites, 
+          ProgressBreakpoint bp) {
+        auto state = std::make_shared<typename RunHandle<Candidate>::State>();
+        auto task = background(size, elites, bp, state);
+        return RunHandle<Candidate>(state, 
+          std::async(std::launch::async, task));
+      }
+
+      RunHandle<Candidate> evolveAsync(int size, int elites, Breakpoint bp) {
+        return evolveAsync(size, elites, adapt(bp));
+      }
+
+      //! Starts evolve() as a task of a shared thread pool.
+      /*!
+      *  Concurrent runs then share the pool's threads. To keep them from
+      *  oversubscribing the machine, OpenMP regions inside the run use 
+      *  \p threads threads rather than a full team each.
+      *  \param pool The pool to run on.
+      *  \param threads OpenMP threads per run.
+      *  \sa evolveAsync(int, int, ProgressBreakpoint)
+      */
+      RunHandle<Candidate> evolveAsync(int size, int elites, 
+          ProgressBreakpoint bp, ThreadPool& pool, int threads = 1) {
+        auto state = std::make_shared<typename RunHandle<Candidate>::State>();
+        auto task = background(size, elites, bp, state);
+        return RunHandle<Candidate>(state, pool.submit([task, threads]{
+          omp_set_num_threads(threads);
+          return task();
+        }));
+      }
+
+      RunHandle<Candidate> evolveAsync(int size, int elites, Breakpoint bp, 
+          ThreadPool& pool, int threads = 1) {
+        return evolveAsync(size, elites, adapt(bp), pool, threads);
+      }
+
+      //! Seeds every operator that draws from the RNG service.
+      /*!
+      *  Each operator gets its own fork of one Random, so a run is fully
+      *  determined by \p value and does not depend on the thread count.
+      *  Simulations are seeded with 0 on construction.
+      */
+      void seed(uint64_t value) {
+        seed(Random(value));
+      }
+
+      void seed(const Random& random) {
+        pr::seed(m_generator, random.fork(0));
+        pr::seed(m_evaluator, random.fork(1));
+        pr::seed(m_selector, random.fork(2));
+        pr::seed(m_pipeline, random.fork(3));
+      }
+
+      //! Lets a caller-held token stop evolve() and resume() early.
+      /*!
+      *  When the token is cancelled, the run stops at the next boundary
+      *  between pipeline stages and returns the best candidate of its 
+      *  last complete generation.
+      */
+      void cancellation(CancellationToken token) {
+        m_cancel = token;
+      }
+
+      //! Enables periodic checkpoints during evolve() and resume().
+      /*!
+      *  Every \p every generations the population and operator states are
+      *  copied into a snapshot buffer, which a background thread writes to
+      *  \p path. If the previous snapshot is still being written, the new 
+      *  one is skipped rather than stalling the run.
+      *  \param path The checkpoint file, replaced atomically on each write.
+      *  \param every Generations between checkpoints, 0 to disable.
+      */
+      void checkpoint(const std::string& path, size_t every) {
+        m_checkpoint_path = path;
+        m_checkpoint_every = every;
+      }
+
+      //! Prepares a run that is driven one generation at a time.
+      /*!
+      *  Generates and evaluates the initial population, as evolve() does 
+      *  before its first generation. The population, the asynchronous 
+      *  workers and the operators' buffers then stay alive between calls 
+      *  to step(), so stepping allocates no more than evolve() would. The 
+      *  simulation must not be moved while a stepped run is in progress.
+      *  \param size The size of the population.
+      *  \param elites Survivors per generation.
+      *  \returns The progress data of generation zero.
+      */
+      const ProgressData& start(int size, int elites) {
+        m_stepping.reset();
+        m_step_data = ProgressData();
+        m_step_start = Clock::now();
+        m_step_elites = elites;
+
+        m_population.resize(size);
+
+        m_stepping.reset(new AsyncScope(*this));
+        m_step_data.evaluations += refresh(m_population, m_step_data);
+        publishThreshold();
+        updateStatistics(m_step_data, m_step_start);
+        m_step_data.generation = 0;
+        return m_step_data;
+      }
+
+      //! Runs up to \p n generations of a run prepared by start().
+      /*!
+      *  Stops early if the cancellation token fires. Elapsed time is 
+      *  measured from start(), so it includes the time between calls.
+      *  \returns The progress data of the last complete generation.
+      */
+      const ProgressData& step(size_t n = 1) {
+        for (size_t i = 0; i < n; i++) {
+          if (!advance(m_step_elites, m_step_data, m_step_start)) {
+            break;
+          }
+        }
+        return m_step_data;
+      }
+
+      //! Progress of the current stepped run.
+      const ProgressData& progress() const {
+        return m_step_data;
+      }
+
+      //! Runs the simulation in steady-state mode.
+      /*!
+      *  Rather than rebuilding the whole population every generation, each
+      *  step selects a handful of parents, mutates copies of them and 
+      *  replaces the worst members of the population with the resulting 
+      *  offspring. Only the offspring are evaluated, so every step costs 
+      *  \p offspring evaluations instead of \p size. Each replacement step 
+      *  is reported as one generation.
+      *  \param size The size of the population.
+      *  \param offspring The number of members replaced per step.
+      *  \param bp The breakpoint checked after every step.
+      */
+      Candidate evolveSteady(int size, int offspring, ProgressBreakpoint bp) {
+        m_stepping.reset();
+
+        ProgressData obs_data;
+        auto start_time = std::chrono::high_resolution_clock::now();
+
+        m_population.resize(size);
+
         m_generator.generate(m_population);
+        obs_data.evaluations += pr::countStale(m_population);
         m_evaluator.evaluate(m_population);
 
+        m_offspring.reserve(offspring);
+
         Candidate elite;
         do {
+          Stopwatch watch;
+
+          // Select parents. The selector marks the rest of the population as
+          // dead, which is undone here since nobody is replaced yet.
+          m_selector.select(m_population, offspring, false);
+          obs_data.stageTimes.select = watch.lap();
+
+          m_offspring.clear();
+          for (auto& cnd : m_population) {
+            if (cnd.alive) {
+              m_offspring.push_back(cnd);
+            }
+            cnd.alive = true;
+          }
 
-          // Select fittest candidates.
-          m_selector.select(m_population, elites, false);
+          // Breed and evaluate the offspring only.
+          m_pipeline.mutate(m_offspring);
+          obs_data.stageTimes.mutate = watch.lap();
+          m_generator.generate(m_offspring);
+          obs_data.stageTimes.generate = watch.lap();
 
-          // Mutate fittest candidates.
-          m_pipeline.mutate(m_population);
+          // Offspring the pipeline left untouched keep a valid fitness.
+          size_t stale = pr::countStale(m_offspring);
+          m_evaluator.evaluate(m_offspring);
+          obs_data.stageTimes.evaluate = watch.lap();
+          obs_data.evaluations += stale;
+          obs_data.evaluationsPerSecond = throughput(stale, 
+            obs_data.stageTimes.evaluate);
 
-          // Augment population to specified size. Note that this may or may
-          // not include the fittest candidates from the previous step as the
-          // behavior is determined by the generator.
-          m_generator.generate(m_population);
+          replaceWorst(m_offspring);
 
-          // Evaluate the new population.
-          m_evaluator.evaluate(m_population);
+          updateStatistics(obs_data, start_time);
+          this->m_progress(obs_data);
 
-          // Update population statistics.
-          typename Candidate::FitnessType sum_fit{};
-          typename Candidate::FitnessType sum_sqrfit{};
+        } while (!bp(m_population, obs_data, elite) && 
+          !cancelled(obs_data, elite));
+        return elite;
+      }
 
-          #pragma omp parallel for reduction(+ : sum_fit, sum_sqrfit)
-          for (int i = 0; i < m_population.size(); i++) {
-            sum_fit = sum_fit + pr::fitness(m_population[i]);
-            sum_sqrfit = pr::fitness(m_population[i]) * 
-              pr::fitness(m_population[i]);
-          }
+      Candidate evolveSteady(int size, int offspring, Breakpoint bp) {
+        return evolveSteady(size, offspring, adapt(bp));
+      }
 
-          auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
-            std::chrono::high_resolution_clock::now() - start_time
-          ).count();
+      //! Enables the asynchronous generate/evaluate pipeline.
+      /*!
+      *  When enabled, evolve() has the generator fill the population chunk
+      *  by chunk on the calling thread while a pool of worker threads pulls
+      *  finished chunks off a bounded queue and evaluates them right away.
+      *  Workers take chunks dynamically, so a slow candidate only holds up 
+      *  the worker that drew it. Selection and mutation still see the whole
+      *  population and remain barriers.
+      *
+      *  The evaluator's evaluateRange() is called concurrently on disjoint
+      *  ranges and must allow it. Its nextGeneration(), if any, is called
+      *  once the last range of a generation is done.
+      *  \param workers Number of evaluation threads, 0 to disable.
+      *  \param chunk Candidates per work item. Should be a multiple of the
+      *  group size when using CompetitiveEvaluator.
+      */
+      void asynchronous(size_t workers, size_t chunk = 16) {
+        m_async_workers = workers;
+        m_async_chunk = std::max<size_t>(chunk, 1);
+      }
 
-          obs_data.meanFitness = sum_fit / m_population.size();
-          obs_data.fitnessVariance = (sum_sqrfit - (sum_fit * sum_fit) / 
-              m_population.size()) / (m_population.size() - 1);
-          obs_data.elapsedTime = elapsed;
-          obs_data.generation++;
-          this->m_progress(obs_data);
+      //! Replaces the worst members of the population with migrants.
+      /*!
+      *  Migrants are expected to carry their fitness with them, so they are
+      *  not re-evaluated. This is meant to be called between generations, 
+      *  e.g. from a breakpoint, by drivers that run several populations.
+      *  \param migrants The candidates to insert. Left in a moved-from state.
+      */
+      void immigrate(Population& migrants) {
+        replaceWorst(migrants);
+      }
 
-        } while (!bp(m_population, elite));
+      const Population& population() const {
+        return m_population;
+      }
+
+      //! Reports a fitness histogram with every generation.
+      /*!
+      *  The bins span [minFitness, maxFitness] of the generation, so this
+      *  costs a second pass over the fitness values.
+      *  \param bins Number of bins, 0 to disable.
+      */
+      void histogram(size_t bins) {
+        m_histogram_bins = bins;
+      }
+
+      //! Lets a racing evaluator abandon candidates that cannot survive.
+      /*!
+      *  After every generation of evolve(), resume() and step(), the
+      *  fitness at \p quantile of the population is handed to the 
+      *  evaluator as the rejection threshold for the next generation (see
+      *  RacingEvaluator); evaluators without threshold() ignore it. 
+      *  Survivors are picked from the next generation, so the previous 
+      *  one's statistics only estimate the cutoff: elites / size mirrors 
+      *  truncation selection, while RouletteSelector keeps even the worst
+      *  members with a small probability, so it wants 1.0, the fitness of
+      *  the previous worst member. The work saved is reported in
+      *  ProgressData::racing.
+      *  \param quantile Share of the population below the threshold, in
+      *  (0, 1], or 0 to disable.
+      */
+      void racing(double quantile) {
+        m_race_quantile = quantile;
+      }
+
+    private:
+      using Clock = std::chrono::high_resolution_clock;
+
+      //! Swaps in the token of a background run for its duration.
+      struct CancelScope {
+        CancelScope(ProtoSimulation& sim, CancellationToken token) : 
+          m_sim(sim), m_previous(sim.m_cancel) {
+          sim.m_cancel = token;
+        }
+
+        ~CancelScope() {
+          m_sim.m_cancel = m_previous;
+        }
+
+        ProtoSimulation& m_sim;
+        CancellationToken m_previous;
+      };
+
+      std::function<Candidate()> background(int size, int elites, 
+          ProgressBreakpoint bp, 
+          std::shared_ptr<typename RunHandle<Candidate>::State> state) {
+        return [this, size, elites, bp, state]() {
+          CancelScope scope(*this, state->token);
+          return evolve(size, elites, [&bp, &state](const Population& pop, 
+              const ProgressData& data, Candidate& elite) {
+            state->publish(data.bestCandidate, data.generation);
+            return bp(pop, data, elite);
+          });
+        };
+      }
+
+      //! Checks for cancellation, handing out the best candidate so far.
+      bool cancelled(const ProgressData& obs_data, Candidate& elite) const {
+        if (!m_cancel.cancelled()) {
+          return false;
+        }
+
+        elite = obs_data.bestCandidate;
+        return true;
+      }
+
+      static ProgressBreakpoint adapt(Breakpoint bp) {
+        return [bp](const Population& pop, const ProgressData&, 
+            Candidate& elite) {
+          return bp(pop, elite);
+        };
+      }
+
+      //! The generational loop shared by evolve() and resume().
+      Candidate run(int elites, ProgressBreakpoint& bp, 
+          ProgressData& obs_data, Clock::time_point start_time) {
+
+        Candidate elite;
+        do {
+          if (!advance(elites, obs_data, start_time)) {
+            elite = obs_data.bestCandidate;
+            break;
+          }
+        } while (!bp(m_population, obs_data, elite) && 
+          !cancelled(obs_data, elite));
+
+        if (m_writer) {
+          m_writer->wait();
+        }
         return elite;
       }
 
-      Candidate evolve(int size, int elites, Population& seed, Breakpoint bp) {
-        m_population = seed;
-        return std::move(evolve(size, elites, bp));
+      //! Runs one generation.
+      /*!
+      *  \returns False if the run was cancelled part way through, in which
+      *  case the statistics still describe the previous generation.
+      */
+      bool advance(int elites, ProgressData& obs_data, 
+          Clock::time_point start_time) {
+        Stopwatch watch;
+
+        // Select fittest candidates.
+        m_selector.select(m_population, elites, false);
+        obs_data.stageTimes.select = watch.lap();
+        if (m_cancel.cancelled()) {
+          return false;
+        }
+
+        // Mutate fittest candidates.
+        m_pipeline.mutate(m_population);
+        obs_data.stageTimes.mutate = watch.lap();
+        if (m_cancel.cancelled()) {
+          return false;
+        }
+
+        // Augment population to specified size and evaluate it. Note that
+        // this may or may not include the fittest candidates from the 
+        // previous step as the behavior is determined by the generator.
+        obs_data.evaluations += refresh(m_population, obs_data);
+        if (m_cancel.cancelled()) {
+          return false;
+        }
+
+        publishThreshold();
+        updateStatistics(obs_data, start_time);
+        this->m_progress(obs_data);
+        snapshot(obs_data);
+        return true;
+      }
+
+      //! Background writer for periodic checkpoints.
+      struct CheckpointWriter {
+        CheckpointWriter() : busy(false) {}
+        ~CheckpointWriter() {
+          if (thread.joinable()) {
+            thread.join();
+          }
+        }
+
+        //! Joins the last write and rethrows any error it ran into.
+        void wait() {
+          if (thread.joinable()) {
+            thread.join();
+          }
+
+          if (error) {
+            std::exception_ptr e = error;
+            error = nullptr;
+            std::rethrow_exception(e);
+          }
+        }
+
+        Checkpoint<CType> data;
+        std::thread thread;
+        std::atomic<bool> busy;
+        std::exception_ptr error;
+      };
+
+      std::string saveStates() const {
+        std::ostringstream os;
+        pr::saveState(m_generator, os);
+        os << ' ';
+        pr::saveState(m_evaluator, os);
+        os << ' ';
+        pr::saveState(m_selector, os);
+        os << ' ';
+        pr::saveState(m_pipeline, os);
+        return os.str();
+      }
+
+      void loadStates(const std::string& state) {
+        std::istringstream is(state);
+        pr::loadState(m_generator, is);
+        pr::loadState(m_evaluator, is);
+        pr::loadState(m_selector, is);
+        pr::loadState(m_pipeline, is);
+      }
+
+      void snapshot(const ProgressData& obs_data) {
+        if (!m_checkpoint_every || 
+            obs_data.generation % m_checkpoint_every != 0) {
+          return;
+        }
+
+        if (!m_writer) {
+          m_writer.reset(new CheckpointWriter());
+        }
+
+        // Skip this one rather than wait for the previous write.
+        CheckpointWriter& w = *m_writer;
+        if (w.busy.load()) {
+          return;
+        }
+        w.wait();
+
+        w.data.generation = obs_data.generation;
+        w.data.evaluations = obs_data.evaluations;
+        w.data.elapsedTime = obs_data.elapsedTime;
+        w.data.meanFitness = obs_data.meanFitness;
+        w.data.fitnessVariance = obs_data.fitnessVariance;
+        w.data.state = saveStates();
+        w.data.population = m_population;
+
+        w.busy = true;
+        std::string path = m_checkpoint_path;
+        w.thread = std::thread([&w, path]{
+          try {
+            w.data.write(path);
+          } catch (...) {
+            w.error = std::current_exception();
+          }
+          w.busy = false;
+        });
+      }
+
+      struct AsyncTask {
+        Population* pop;
+        size_t first;
+        size_t last;
+      };
+
+      //! State of the asynchronous pipeline for the duration of one run.
+      struct AsyncStage {
+        AsyncStage(size_t capacity) : queue(capacity), pending(0) {}
+
+        BoundedQueue<AsyncTask> queue;
+        std::vector<std::thread> workers;
+        //! Evaluation time of each worker during the current refresh.
+        std::vector<std::chrono::nanoseconds> busy;
+        std::mutex lock;
+        std::condition_variable idle;
+        size_t pending;
+      };
+
+      //! Starts the evaluation workers, if enabled, and stops them on exit.
+      struct AsyncScope {
+        AsyncScope(ProtoSimulation& sim) : m_sim(sim) {
+          if (!sim.m_async_workers) {
+            return;
+          }
+
+          sim.m_async.reset(new AsyncStage(2 * sim.m_async_workers));
+          sim.m_async->busy.resize(sim.m_async_workers);
+          for (size_t w = 0; w < sim.m_async_workers; w++) {
+            sim.m_async->workers.emplace_back(&ProtoSimulation::work, &sim, w);
+          }
+        }
+
+        ~AsyncScope() {
+          if (!m_sim.m_async) {
+            return;
+          }
+
+          m_sim.m_async->queue.close();
+          for (auto& w : m_sim.m_async->workers) {
+            w.join();
+          }
+          m_sim.m_async.reset();
+        }
+
+        ProtoSimulation& m_sim;
+      };
+
+      static double throughput(size_t count, std::chrono::nanoseconds time) {
+        return time.count() ? count * 1e9 / time.count() : 0.0;
+      }
+
+      //! Fills the dead members of the population and evaluates it.
+      /*!
+      *  \return The number of members that needed evaluating, i.e. those
+      *  whose fitness was stale after generation.
+      */
+      size_t refresh(Population& pop, ProgressData& obs_data) {
+        StageTimes& times = obs_data.stageTimes;
+        Stopwatch watch;
+
+        if (!m_async) {
+          m_generator.generate(pop);
+          times.generate = watch.lap();
+          size_t stale = pr::countStale(pop);
+          m_evaluator.evaluate(pop);
+          times.evaluate = watch.lap();
+          obs_data.evaluationsPerSecond = throughput(stale, times.evaluate);
+          return stale;
+        }
+
+        // Generation overlaps evaluation, so the evaluate stage is reported
+        // as whatever the refresh took beyond generating.
+        Stopwatch total;
+        std::fill(m_async->busy.begin(), m_async->busy.end(), 
+          std::chrono::nanoseconds(0));
+        times.generate = std::chrono::nanoseconds(0);
+
+        // Chunks are handed to the workers as soon as they are generated.
+        size_t stale = 0;
+        for (size_t first = 0; first < pop.size(); first += m_async_chunk) {
+          size_t last = std::min(first + m_async_chunk, pop.size());
+          watch.lap();
+          m_generator.generateRange(pop, first, last);
+          times.generate += watch.lap();
+          stale += pr::countStale(pop, first, last);
+
+          {
+            std::lock_guard<std::mutex> lock(m_async->lock);
+            m_async->pending++;
+          }
+          m_async->queue.push(AsyncTask{&pop, first, last});
+        }
+
+        std::unique_lock<std::mutex> lock(m_async->lock);
+        m_async->idle.wait(lock, [this]{ return m_async->pending == 0; });
+        pr::nextGeneration(m_evaluator);
+
+        auto wall = total.lap();
+        times.evaluate = wall - times.generate;
+        obs_data.evaluationsPerSecond = throughput(stale, wall);
+
+        obs_data.workerTimes.resize(m_async->busy.size());
+        for (size_t w = 0; w < m_async->busy.size(); w++) {
+          obs_data.workerTimes[w].busy = m_async->busy[w];
+          obs_data.workerTimes[w].idle = wall - m_async->busy[w];
+        }
+        return stale;
+      }
+
+      //! Evaluation worker loop.
+      void work(size_t index) {
+        AsyncTask task;
+        while (m_async->queue.pop(task)) {
+          Stopwatch watch;
+          m_evaluator.evaluateRange(*task.pop, task.first, task.last);
+          m_async->busy[index] += watch.lap();
+
+          std::lock_guard<std::mutex> lock(m_async->lock);
+          if (--m_async->pending == 0) {
+            m_async->idle.notify_all();
+          }
+        }
+      }
+
+      //! Hands the evaluator the racing threshold, if enabled.
+      void publishThreshold() {
+        if (m_race_quantile <= 0.0 || m_population.empty()) {
+          return;
+        }
+
+        size_t n = m_population.size();
+        m_race_fitness.resize(n);
+        for (size_t i = 0; i < n; i++) {
+          m_race_fitness[i] = pr::scalar(pr::fitness(m_population[i]));
+        }
+
+        size_t k = std::min(n - 1, static_cast<size_t>(
+          std::max(std::ceil(m_race_quantile * n) - 1, 0.0)));
+        std::nth_element(m_race_fitness.begin(), m_race_fitness.begin() + k,
+          m_race_fitness.end());
+        pr::threshold(m_evaluator, m_race_fitness[k]);
+      }
+
+      void replaceWorst(Population& incoming) {
+        size_t count = std::min(incoming.size(), m_population.size());
+
+        // Fitness is an error measure here (see the selector calls above),
+        // so the worst members are the ones with the highest fitness.
+        m_order.resize(m_population.size());
+        std::iota(m_order.begin(), m_order.end(), 0);
+        std::nth_element(m_order.begin(), m_order.begin() + count, 
+          m_order.end(), [this](size_t a, size_t b) {
+            return pr::scalar(pr::fitness(m_population[a])) > 
+              pr::scalar(pr::fitness(m_population[b]));
+          });
+
+        for (size_t i = 0; i < count; i++) {
+          m_population[m_order[i]] = std::move(incoming[i]);
+        }
+      }
+
+      void updateStatistics(ProgressData& obs_data, Clock::time_point start) {
+        Stopwatch watch;
+        FitnessSummary summary = summarize(m_population, 
+          &obs_data.threadTimes);
+
+        // Kept in fractional seconds so that deadlines can be checked 
+        // against it.
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+
+        obs_data.meanFitness = summary.mean;
+        obs_data.fitnessVariance = summary.variance();
+        obs_data.minFitness = summary.min;
+        obs_data.maxFitness = summary.max;
+        obs_data.bestIndex = summary.minIndex;
+        if (summary.count) {
+          obs_data.bestCandidate = m_population[summary.minIndex];
+        }
+        obs_data.histogram = pr::histogram(m_population, m_histogram_bins,
+          summary.min, summary.max);
+        obs_data.cache = pr::cacheStats(m_evaluator);
+        obs_data.racing = pr::raceStats(m_evaluator);
+        obs_data.stageTimes.statistics = watch.lap();
+        obs_data.elapsedTime = elapsed.count();
+        obs_data.generation++;
       }
 
     private:
@@ -190,6 +929,29 @@ namespace pr {
       Selector m_selector;
       Mutator m_pipeline;
       Population m_population;
+      Population m_offspring;
+      std::vector<size_t> m_order;
+
+      size_t m_async_workers;
+      size_t m_async_chunk;
+      std::unique_ptr<AsyncStage> m_async;
+
+      std::string m_checkpoint_path;
+      size_t m_checkpoint_every;
+      std::unique_ptr<CheckpointWriter> m_writer;
+
+      size_t m_histogram_bins;
+      CancellationToken m_cancel;
+
+      double m_race_quantile;
+      std::vector<double> m_race_fitness;
+
+      ProgressData m_step_data;
+      Clock::time_point m_step_start;
+      int m_step_elites;
+      // Declared last so that the workers stop before anything they use
+      // is destroyed.
+      std::unique_ptr<AsyncScope> m_stepping;
   };
 }
 
@@ -0,0 +1,166 @@
+#ifndef STATISTICS_H
+#define STATISTICS_H
+
+#include <vector>
+#include <limits>
+#include <cmath>
+#include <algorithm>
+#include <omp.h>
+
+#include "population.h"
+#include "timing.h"
+
+namespace pr {
+
+  //! Running summary of a set of fitness values.
+  /*!
+  *  Mean and variance are accumulated with Welford's update, which stays
+  *  accurate where the naive sum of squares cancels catastrophically. Two
+  *  partial summaries are combined with Chan's merge, so every thread can
+  *  summarize its own slice of the population and the results are folded
+  *  together afterwards.
+  */
+  struct FitnessSummary {
+    size_t count = 0;
+    double mean = 0.0;
+    double m2 = 0.0;
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+    size_t minIndex = 0;
+    size_t maxIndex = 0;
+
+    //! Adds the fitness \p x of the member at \p index.
+    void push(double x, size_t index) {
+      count++;
+      double delta = x - mean;
+      mean += delta / count;
+      m2 += delta * (x - mean);
+
+      if (x < min) {
+        min = x;
+        minIndex = index;
+      }
+      if (x > max) {
+        max = x;
+        maxIndex = index;
+      }
+    }
+
+    //! Folds in the summary of a slice that follows this one.
+    /*!
+    *  On ties the extremes of this summary are kept, so merging slices in
+    *  index order reports the lowest index.
+    */
+    void merge(const FitnessSummary& other) {
+      if (!other.count) {
+        return;
+      }
+      if (!count) {
+        *this = other;
+        return;
+      }
+
+      size_t total = count + other.count;
+      double delta = other.mean - mean;
+      mean += delta * other.count / total;
+      m2 += other.m2 + delta * delta *
+        (static_cast<double>(count) * other.count / total);
+      count = total;
+
+      if (other.min < min) {
+        min = other.min;
+        minIndex = other.minIndex;
+      }
+      if (other.max > max) {
+        max = other.max;
+        maxIndex = other.maxIndex;
+      }
+    }
+
+    //! Sample variance, zero for fewer than two values.
+    double variance() const {
+      return count > 1 ? m2 / (count - 1) : 0.0;
+    }
+  };
+
+  //! Summarizes the fitness of a population in a single parallel pass.
+  /*!
+  *  Each thread accumulates a contiguous slice and the partial summaries
+  *  are merged in slice order, so the result does not depend on timing.
+  *  \param pop The population to summarize.
+  *  \param times If given, receives the busy and idle time of every thread
+  *  in the region.
+  */
+  template <typename CType>
+  FitnessSummary summarize(const Population<CType>& pop,
+      std::vector<ThreadTime>* times = nullptr) {
+    int threads = omp_get_max_threads();
+    std::vector<FitnessSummary> partial(threads);
+    if (times) {
+      times->assign(threads, ThreadTime());
+    }
+
+    #pragma omp parallel num_threads(threads)
+    {
+      Stopwatch watch;
+      FitnessSummary local;
+
+      #pragma omp for schedule(static) nowait
+      for (long i = 0; i < static_cast<long>(pop.size()); i++) {
+        local.push(pr::scalar(pr::fitness(pop[i])), i);
+      }
+
+      // Written once per thread to keep the slots off the hot loop.
+      partial[omp_get_thread_num()] = local;
+
+      if (times) {
+        ThreadTime& t = (*times)[omp_get_thread_num()];
+        t.busy = watch.lap();
+        #pragma omp barrier
+        t.idle = watch.lap();
+      }
+    }
+
+    FitnessSummary total;
+    for (auto& p : partial) {
+      total.merge(p);
+    }
+    return total;
+  }
+
+  //! Counts fitness values into \p bins equal-width bins over [min, max].
+  /*!
+  *  The range has to be known up front, so this is a second, cheap pass
+  *  over the fitness values only and is skipped unless asked for.
+  */
+  template <typename CType>
+  std::vector<size_t> histogram(const Population<CType>& pop, size_t bins,
+      double min, double max) {
+    std::vector<size_t> counts(bins, 0);
+    if (!bins || pop.empty()) {
+      return counts;
+    }
+
+    double width = (max - min) / bins;
+
+    #pragma omp parallel
+    {
+      std::vector<size_t> local(bins, 0);
+
+      #pragma omp for schedule(static) nowait
+      for (long i = 0; i < static_cast<long>(pop.size()); i++) {
+        double x = pr::scalar(pr::fitness(pop[i]));
+        size_t bin = width > 0.0 ? static_cast<size_t>((x - min) / width) : 0;
+        local[std::min(bin, bins - 1)]++;
+      }
+
+      #pragma omp critical
+      for (size_t b = 0; b < bins; b++) {
+        counts[b] += local[b];
+      }
+    }
+    return counts;
+  }
+}
+
+#endif
@@ -0,0 +1,238 @@
+#ifndef TERMINATION_H
+#define TERMINATION_H
+
+#include <limits>
+#include <chrono>
+#include <type_traits>
+
+#include "simulation.h"
+#include "type_traits.h"
+
+namespace pr {
+
+  //! Base termination criterion.
+  /*!
+  *  Criteria decide when a run stops by looking only at the ProgressData
+  *  the simulation has already computed, so checking them costs O(1) per
+  *  generation. A criterion can be passed anywhere a breakpoint is
+  *  expected; when it fires, the elite is set to the best candidate of the
+  *  final generation. Criteria compose with || and &&.
+  *  \tparam CType The candidate type of the simulation.
+  */
+  template <typename CType>
+  class Termination {
+
+    static_assert(is_specialization_of<Candidate, CType>::value,
+        "Template parameter must specialize Candidate.");
+
+    public:
+      using Candidate = CType;
+      using Population = pr::Population<CType>;
+      using ProgressData = typename pr::Simulation<CType>::ProgressData;
+
+    public:
+      Termination() = default;
+      virtual ~Termination() = default;
+
+      /*!
+      *  Called once per generation, in order.
+      *  \returns True if the run should stop.
+      */
+      virtual bool test(const ProgressData&) = 0;
+
+      bool operator()(const Population&, const ProgressData& data,
+          Candidate& elite) {
+        if (!test(data)) {
+          return false;
+        }
+
+        elite = data.bestCandidate;
+        return true;
+      }
+  };
+
+  //! Stops once the best fitness reaches \p target or below.
+  template <typename CType>
+  class TargetFitness : public Termination<CType> {
+
+    using typename Termination<CType>::ProgressData;
+
+    public:
+      TargetFitness(double target = 0.0) : m_target(target) {}
+
+      bool test(const ProgressData& data) {
+        return data.minFitness <= m_target;
+      }
+
+    private:
+      double m_target;
+  };
+
+  //! Stops when the best fitness has not improved for a number of
+  //! generations.
+  template <typename CType>
+  class Stagnation : public Termination<CType> {
+
+    using typename Termination<CType>::ProgressData;
+
+    public:
+      /*!
+      *  \param generations Generations without improvement to tolerate.
+      *  \param tolerance Improvements of at most this much do not count.
+      */
+      Stagnation(size_t generations, double tolerance = 0.0) :
+        m_generations(generations), m_tolerance(tolerance),
+        m_best(std::numeric_limits<double>::infinity()), m_stale(0) {}
+
+      bool test(const ProgressData& data) {
+        if (data.minFitness < m_best - m_tolerance) {
+          m_best = data.minFitness;
+          m_stale = 0;
+        } else {
+          m_stale++;
+        }
+        return m_stale >= m_generations;
+      }
+
+    private:
+      size_t m_generations;
+      double m_tolerance;
+      double m_best;
+      size_t m_stale;
+  };
+
+  //! Stops once the run has used up its wall-clock budget.
+  /*!
+  *  The budget is measured from the start of the run, as reported by
+  *  ProgressData::elapsedTime. It is checked between generations, so a
+  *  run overshoots by at most one generation and then returns the best
+  *  candidate found so far.
+  */
+  template <typename CType>
+  class Deadline : public Termination<CType> {
+
+    using typename Termination<CType>::ProgressData;
+
+    public:
+      template <typename Rep, typename Period>
+      Deadline(std::chrono::duration<Rep, Period> budget) :
+        m_budget(std::chrono::duration<double>(budget).count()) {}
+
+      bool test(const ProgressData& data) {
+        return data.elapsedTime >= m_budget;
+      }
+
+    private:
+      double m_budget;
+  };
+
+  //! Stops once the run has performed \p evaluations fitness evaluations.
+  template <typename CType>
+  class EvaluationBudget : public Termination<CType> {
+
+    using typename Termination<CType>::ProgressData;
+
+    public:
+      EvaluationBudget(size_t evaluations) : m_evaluations(evaluations) {}
+
+      bool test(const ProgressData& data) {
+        return data.evaluations >= m_evaluations;
+      }
+
+    private:
+      size_t m_evaluations;
+  };
+
+  //! Stops once the population has converged.
+  /*!
+  *  Diversity is judged by the fitness variance of the population, which
+  *  the simulation computes anyway. A genotypic measure would need another
+  *  pass over the population.
+  */
+  template <typename CType>
+  class DiversityCollapse : public Termination<CType> {
+
+    using typename Termination<CType>::ProgressData;
+
+    public:
+      DiversityCollapse(double variance = 0.0) : m_variance(variance) {}
+
+      bool test(const ProgressData& data) {
+        return data.fitnessVariance <= m_variance;
+      }
+
+    private:
+      double m_variance;
+  };
+
+  //! Stops when either criterion does.
+  /*!
+  *  Both criteria are tested every generation so that stateful ones, such
+  *  as Stagnation, never miss a generation.
+  */
+  template <typename CType, typename AType, typename BType>
+  class AnyOf : public Termination<CType> {
+
+    using typename Termination<CType>::ProgressData;
+
+    public:
+      AnyOf(AType a, BType b) : m_a(a), m_b(b) {}
+
+      bool test(const ProgressData& data) {
+        bool a = m_a.test(data);
+        bool b = m_b.test(data);
+        return a || b;
+      }
+
+    private:
+      AType m_a;
+      BType m_b;
+  };
+
+  //! Stops when both criteria do.
+  template <typename CType, typename AType, typename BType>
+  class AllOf : public Termination<CType> {
+
+    using typename Termination<CType>::ProgressData;
+
+    public:
+      AllOf(AType a, BType b) : m_a(a), m_b(b) {}
+
+      bool test(const ProgressData& data) {
+        bool a = m_a.test(data);
+        bool b = m_b.test(data);
+        return a && b;
+      }
+
+    private:
+      AType m_a;
+      BType m_b;
+  };
+
+  //! Failure specialization.
+  template <typename T, typename = void>
+  struct is_termination : std::false_type {};
+
+  //! Detects classes derived from Termination.
+  template <typename T>
+  struct is_termination<T, typename type_void<typename T::Candidate>::type> :
+    std::is_base_of<Termination<typename T::Candidate>, T> {};
+
+  template <typename AType, typename BType>
+  typename std::enable_if<
+    is_termination<AType>::value && is_termination<BType>::value,
+    AnyOf<typename AType::Candidate, AType, BType>
+  >::type operator||(const AType& a, const BType& b) {
+    return AnyOf<typename AType::Candidate, AType, BType>(a, b);
+  }
+
+  template <typename AType, typename BType>
+  typename std::enable_if<
+    is_termination<AType>::value && is_termination<BType>::value,
+    AllOf<typename AType::Candidate, AType, BType>
+  >::type operator&&(const AType& a, const BType& b) {
+    return AllOf<typename AType::Candidate, AType, BType>(a, b);
+  }
+}
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef TIMING_H
+#define TIMING_H
+
+#include <chrono>
+
+namespace pr {
+
+  //! Time spent in each stage of the last generation.
+  struct StageTimes {
+    std::chrono::nanoseconds generate{0};
+    std::chrono::nanoseconds evaluate{0};
+    std::chrono::nanoseconds select{0};
+    std::chrono::nanoseconds mutate{0};
+    std::chrono::nanoseconds statistics{0};
+  };
+
+  //! Split of one thread's time in a parallel region.
+  /*!
+  *  Busy time is spent doing work, idle time waiting for work or for the
+  *  other threads at the closing barrier. A large idle share means the
+  *  work is unevenly divided.
+  */
+  struct ThreadTime {
+    std::chrono::nanoseconds busy{0};
+    std::chrono::nanoseconds idle{0};
+  };
+
+  //! Measures consecutive intervals on a monotonic clock.
+  class Stopwatch {
+
+    public:
+      using Clock = std::chrono::steady_clock;
+
+    public:
+      Stopwatch() : m_last(Clock::now()) {}
+
+      //! Returns the time since the last lap, or construction.
+      std::chrono::nanoseconds lap() {
+        Clock::time_point now = Clock::now();
+        auto elapsed = now - m_last;
+        m_last = now;
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed);
+      }
+
+    private:
+      Clock::time_point m_last;
+  };
+}
+
+#endif
@@ -2,6 +2,7 @@
 #define TYPE_TRAITS_H
 
 #include <tuple>
+#include <functional>
 #include <typeinfo>
 #include <type_traits>
 #include <boost/type_traits.hpp> // for has_equal_to
@@ -1,6 +1,14 @@
 #ifndef UTILITY_H
 #define UTILITY_H
 
+#include <tuple>
+#include <array>
+#include <ostream>
+#include <iterator>
+#include <algorithm>
+
+#include "candidate.h"
+
 namespace pr {
 
   template <
@@ -58,27 +66,44 @@ namespace pr {
     return o;
   }
 
-  namespace boost {
-    namespace serialization {
-      template <unsigned int N>
-      struct TupleSerializer {
-        template <class Archive, typename... Ps>
-        static void serialize(Archive& a, std::tuple<Ps...>& p, const unsigned int v) {
-          a & std::get<N - 1>(p); 
-          TupleSerializer<N - 1>::serialize(a, p, v);
-        }
-      };
-
-      template <>
-      struct TupleSerializer<0> {
-        template <class Archive, typename... Ps>
-        static void serialize(Archive& a, std::tuple<Ps...>& p, const unsigned int v) {}
-      };
+}
 
+// Serialization hooks must live in boost::serialization (or the namespace of
+// the serialized type) for the archives to find them.
+namespace boost {
+  namespace serialization {
+    template <unsigned int N>
+    struct TupleSerializer {
       template <class Archive, typename... Ps>
-      void serialize(Archive& a, std::tuple<Ps...>& p, const unsigned int v) {
-        TupleSerializer<sizeof...(Ps)>::serialize(a, p, v);
+      static void serialize(Archive& a, std::tuple<Ps...>& p, const unsigned int v) {
+        a & std::get<N - 1>(p); 
+        TupleSerializer<N - 1>::serialize(a, p, v);
       }
+    };
+
+    template <>
+    struct TupleSerializer<0> {
+      template <class Archive, typename... Ps>
+      static void serialize(Archive& a, std::tuple<Ps...>& p, const unsigned int v) {}
+    };
+
+    template <class Archive, typename... Ps>
+    void serialize(Archive& a, std::tuple<Ps...>& p, const unsigned int v) {
+      TupleSerializer<sizeof...(Ps)>::serialize(a, p, v);
+    }
+
+    //! Serializes a candidate's progeny, fitness and flags.
+    /*!
+    *  The progeny type needs its own serialization hook, e.g. from
+    *  boost/serialization/string.hpp or boost/serialization/array.hpp.
+    */
+    template <class Archive, typename Base, typename Fitness>
+    void serialize(Archive& a, pr::Candidate<Base, Fitness>& c, const unsigned int v) {
+      a & pr::progeny(c);
+      a & pr::fitness(c);
+      a & c.alive;
+      a & c.valid;
+      a & c.estimated;
     }
   }
 }
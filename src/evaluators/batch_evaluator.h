@@ -0,0 +1,166 @@
+#ifndef BATCH_EVALUATOR_H
+#define BATCH_EVALUATOR_H
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <omp.h>
+
+#include "../core/evaluator.h"
+#include "../core/candidate.h"
+#include "../core/type_traits.h"
+
+namespace pr {
+
+  //! View of a batch of genomes packed as a structure of arrays.
+  /*!
+  *  Gene j of every candidate in the batch is contiguous: gene(j)[b] is
+  *  gene j of candidate b. A fitness function can thus work on a whole
+  *  batch with unit-stride loops, or treat the buffer as the column-major
+  *  matrix of one genome per column with leading dimension stride().
+  *  The lanes from size() up to stride() are zero padding, so kernels may
+  *  run over full strides.
+  *  \tparam T The gene type.
+  */
+  template <typename T>
+  class Batch {
+
+    public:
+      Batch(const T* data, size_t genes, size_t size, size_t stride) :
+        m_data(data), m_genes(genes), m_size(size), m_stride(stride) {}
+
+      //! Gene \p j of all candidates.
+      const T* gene(size_t j) const { return m_data + j * m_stride; }
+
+      const T* data() const { return m_data; }
+
+      //! Genes per candidate.
+      size_t genes() const { return m_genes; }
+
+      //! Candidates in this batch.
+      size_t size() const { return m_size; }
+
+      //! Distance between consecutive genes, the batch capacity.
+      size_t stride() const { return m_stride; }
+
+    private:
+      const T* m_data;
+      size_t m_genes;
+      size_t m_size;
+      size_t m_stride;
+  };
+
+  //! Evaluates stale candidates in fixed-size, contiguously packed batches.
+  /*!
+  *  The stale members are gathered into batches of at most \p batch
+  *  genomes. Each batch is transposed into a Batch buffer and handed to
+  *  the fitness function together with a contiguous array that receives
+  *  one fitness per candidate. The fitness function sees no candidates
+  *  and no population, so it can be vectorized or written as a matrix
+  *  product, e.g. scoring a batch of std::array<double, N> against a
+  *  linear model is a single M x N by N x batch multiplication.
+  *
+  *  Batches are scored in parallel, each thread packing into a buffer of
+  *  its own that is reused from batch to batch.
+  *  \tparam CType The candidate type, whose progeny is a std::array of
+  *  arithmetic genes.
+  */
+  template <typename CType>
+  class BatchEvaluator : public Evaluator<CType> {
+
+    using Population = pr::Population<CType>;
+    using BaseType = typename CType::BaseType;
+    using FitnessType = typename CType::FitnessType;
+
+    static_assert(is_std_array<BaseType>::value,
+        "BatchEvaluator requires std::array genomes.");
+
+    public:
+      using Gene = typename BaseType::value_type;
+      using Score = std::function<void(const Batch<Gene>&, FitnessType*)>;
+
+      static_assert(std::is_arithmetic<Gene>::value,
+          "BatchEvaluator requires arithmetic genes.");
+
+    public:
+      /*!
+      *  \param score Fills the fitness of every candidate in a batch.
+      *  \param batch Maximum number of candidates per batch.
+      *  \param parallel Whether batches are scored on several threads.
+      */
+      BatchEvaluator(Score score, size_t batch = 256, bool parallel = true) :
+        Evaluator<CType>(), m_score(std::move(score)),
+        m_batch(std::max<size_t>(batch, 1)), m_parallel(parallel) {}
+
+      void evaluate(Population& pop) {
+        std::vector<size_t> indices = stale(pop);
+        long batches = (indices.size() + m_batch - 1) / m_batch;
+
+        #pragma omp parallel if (m_parallel && batches > 1)
+        {
+          Buffers buffers(m_batch);
+
+          #pragma omp for schedule(dynamic)
+          for (long b = 0; b < batches; b++) {
+            size_t first = b * m_batch;
+            score(pop, &indices[first],
+              std::min(m_batch, indices.size() - first), buffers);
+          }
+        }
+      }
+
+      void evaluateRange(Population& pop, size_t first, size_t last) {
+        std::vector<size_t> indices = stale(pop, first, last);
+        Buffers buffers(m_batch);
+        for (size_t k = 0; k < indices.size(); k += m_batch) {
+          score(pop, &indices[k], std::min(m_batch, indices.size() - k),
+            buffers);
+        }
+      }
+
+      size_t batchSize() const {
+        return m_batch;
+      }
+
+    private:
+      static const size_t Genes = std::tuple_size<BaseType>::value;
+
+      struct Buffers {
+        explicit Buffers(size_t batch) : genes(Genes * batch),
+          fitness(batch) {}
+
+        std::vector<Gene> genes;
+        std::vector<FitnessType> fitness;
+      };
+
+      void score(Population& pop, const size_t* indices, size_t count,
+          Buffers& buffers) {
+        Gene* genes = buffers.genes.data();
+        if (count < m_batch) {
+          std::fill(buffers.genes.begin(), buffers.genes.end(), Gene());
+        }
+
+        for (size_t b = 0; b < count; b++) {
+          const BaseType& genome = pr::progeny(pop[indices[b]]);
+          for (size_t j = 0; j < Genes; j++) {
+            genes[j * m_batch + b] = genome[j];
+          }
+        }
+
+        m_score(Batch<Gene>(genes, Genes, count, m_batch),
+          buffers.fitness.data());
+
+        for (size_t b = 0; b < count; b++) {
+          pr::fitness(pop[indices[b]]) = buffers.fitness[b];
+          pop[indices[b]].valid = true;
+        }
+      }
+
+    private:
+      Score m_score;
+      size_t m_batch;
+      bool m_parallel;
+  };
+}
+
+#endif
@@ -0,0 +1,264 @@
+#ifndef CACHING_EVALUATOR_H
+#define CACHING_EVALUATOR_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstring>
+#include <limits>
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+#include <omp.h>
+
+#include "../core/evaluator.h"
+#include "../core/random.h"
+#include "../core/serialization.h"
+#include "../core/type_traits.h"
+#include "../util/concurrent_map.h"
+
+namespace pr {
+
+  //! Hash of a progeny, for the types candidates are commonly built on.
+  template <typename T, typename Enable = void>
+  struct ProgenyHash;
+
+  //! Arithmetic and enum types use std::hash.
+  template <typename T>
+  struct ProgenyHash<
+    T,
+    typename std::enable_if<
+      std::is_arithmetic<T>::value || std::is_enum<T>::value
+    >::type
+  > {
+    size_t operator()(const T& t) const {
+      return std::hash<T>()(t);
+    }
+  };
+
+  //! Strings use std::hash.
+  template <typename C>
+  struct ProgenyHash<std::basic_string<C>> {
+    size_t operator()(const std::basic_string<C>& s) const {
+      return std::hash<std::basic_string<C>>()(s);
+    }
+  };
+
+  //! Other containers combine the hashes of their elements.
+  template <typename T>
+  struct ProgenyHash<
+    T,
+    typename std::enable_if<
+      has_value_type<T>::value && !std::is_arithmetic<T>::value &&
+      !is_specialization_of<std::basic_string, T>::value
+    >::type
+  > {
+    size_t operator()(const T& t) const {
+      ProgenyHash<typename T::value_type> element;
+      size_t h = 0xcbf29ce484222325ull;
+      for (const auto& v : t) {
+        h = (h ^ element(v)) * 0x100000001b3ull;
+      }
+      return h;
+    }
+  };
+
+  //! Remaining trivially copyable types are hashed by their bytes.
+  template <typename T>
+  struct ProgenyHash<
+    T,
+    typename std::enable_if<
+      !has_value_type<T>::value && !std::is_arithmetic<T>::value &&
+      !std::is_enum<T>::value && std::is_trivially_copyable<T>::value
+    >::type
+  > {
+    size_t operator()(const T& t) const {
+      unsigned char bytes[sizeof(T)];
+      std::memcpy(bytes, &t, sizeof(T));
+
+      size_t h = 0xcbf29ce484222325ull;
+      for (unsigned char b : bytes) {
+        h = (h ^ b) * 0x100000001b3ull;
+      }
+      return h;
+    }
+  };
+
+  //! Memoizes the fitness computed by another evaluator.
+  /*!
+  *  Every stale member is first looked up in a bounded ConcurrentMap keyed by
+  *  its progeny. Only the members that miss are handed to the wrapped
+  *  evaluator, and a genome that appears several times in one batch is
+  *  evaluated once. Converged populations consist mostly of copies, so
+  *  with an expensive fitness function most of the evaluation time is
+  *  saved.
+  *
+  *  Only wrap evaluators whose fitness depends on the progeny alone: a
+  *  CompetitiveEvaluator with groups of more than one member, or a noisy
+  *  fitness function, would be frozen at its first result. Copies of a
+  *  CachingEvaluator share the same cache.
+  *  \tparam CType The candidate type.
+  *  \tparam EType The wrapped evaluator.
+  */
+  template <typename CType, typename EType>
+  class CachingEvaluator : public Evaluator<CType> {
+
+    using Population = pr::Population<CType>;
+    using BaseType = typename CType::BaseType;
+    using FitnessType = typename CType::FitnessType;
+    using Cache = ConcurrentMap<BaseType, FitnessType, ProgenyHash<BaseType>>;
+
+    static const size_t None = std::numeric_limits<size_t>::max();
+
+    public:
+      /*!
+      *  \param evaluator The evaluator that computes missing values.
+      *  \param capacity Number of genomes remembered.
+      *  \param shards Number of independently locked parts of the cache.
+      */
+      CachingEvaluator(EType evaluator, size_t capacity = 1 << 16,
+          size_t shards = 64) : Evaluator<CType>(),
+        m_evaluator(std::move(evaluator)),
+        m_cache(std::make_shared<Cache>(capacity, shards)) {}
+
+      void evaluate(Population& pop) {
+        std::vector<size_t> misses;
+
+        #pragma omp parallel
+        {
+          std::vector<size_t> local;
+
+          #pragma omp for schedule(static) nowait
+          for (long i = 0; i < static_cast<long>(pop.size()); i++) {
+            if (pop[i].valid) {
+              continue;
+            }
+            if (m_cache->find(pr::progeny(pop[i]), pr::fitness(pop[i]))) {
+              pop[i].valid = true;
+            } else {
+              local.push_back(i);
+            }
+          }
+
+          #pragma omp critical
+          misses.insert(misses.end(), local.begin(), local.end());
+        }
+
+        std::sort(misses.begin(), misses.end());
+        evaluateMisses(pop, misses, [this](Population& batch) {
+          m_evaluator.evaluate(batch);
+        });
+      }
+
+      void evaluateRange(Population& pop, size_t first, size_t last) {
+        std::vector<size_t> misses;
+        for (size_t i = first; i < last; i++) {
+          if (pop[i].valid) {
+            continue;
+          }
+          if (m_cache->find(pr::progeny(pop[i]), pr::fitness(pop[i]))) {
+            pop[i].valid = true;
+          } else {
+            misses.push_back(i);
+          }
+        }
+
+        evaluateMisses(pop, misses, [this](Population& batch) {
+          m_evaluator.evaluateRange(batch, 0, batch.size());
+        });
+      }
+
+      bool isNatural() {
+        return m_evaluator.isNatural();
+      }
+
+      CacheStats cacheStats() const {
+        return m_cache->stats();
+      }
+
+      //! Forgets every remembered fitness, e.g. after the fitness function
+      //! changed.
+      void clear() {
+        m_cache->clear();
+      }
+
+      void nextGeneration() {
+        pr::nextGeneration(m_evaluator);
+      }
+
+      void seed(const Random& random) {
+        pr::seed(m_evaluator, random);
+      }
+
+      void saveState(std::ostream& os) const {
+        pr::saveState(m_evaluator, os);
+      }
+
+      void loadState(std::istream& is) {
+        pr::loadState(m_evaluator, is);
+      }
+
+    private:
+      //! Evaluates each distinct genome among \p misses once, stores the
+      //! results and hands them to the duplicates.
+      template <typename FType>
+      void evaluateMisses(Population& pop, const std::vector<size_t>& misses,
+          FType evaluate) {
+        if (misses.empty()) {
+          return;
+        }
+
+        // Maps each miss to the batch position of the first copy of its
+        // genome, keyed by index so that no genome is copied.
+        auto hash = [&pop](size_t i) {
+          return ProgenyHash<BaseType>()(pr::progeny(pop[i]));
+        };
+        auto equal = [&pop](size_t a, size_t b) {
+          return pr::progeny(pop[a]) == pr::progeny(pop[b]);
+        };
+        std::unordered_map<size_t, size_t, decltype(hash), decltype(equal)>
+          first(misses.size(), hash, equal);
+
+        std::vector<size_t> slot(misses.size());
+        std::vector<size_t> unique;
+        for (size_t k = 0; k < misses.size(); k++) {
+          auto res = first.emplace(misses[k], unique.size());
+          if (res.second) {
+            slot[k] = None;
+            unique.push_back(misses[k]);
+          } else {
+            slot[k] = res.first->second;
+          }
+        }
+        first.clear();
+
+        Population batch;
+        batch.reserve(unique.size());
+        for (size_t i : unique) {
+          batch.push_back(std::move(pop[i]));
+        }
+
+        evaluate(batch);
+
+        #pragma omp parallel for schedule(static)
+        for (long b = 0; b < static_cast<long>(batch.size()); b++) {
+          m_cache->insert(pr::progeny(batch[b]), pr::fitness(batch[b]));
+          batch[b].valid = true;
+          pop[unique[b]] = std::move(batch[b]);
+        }
+
+        for (size_t k = 0; k < misses.size(); k++) {
+          if (slot[k] != None) {
+            pr::fitness(pop[misses[k]]) = pr::fitness(pop[unique[slot[k]]]);
+            pop[misses[k]].valid = true;
+          }
+        }
+      }
+
+    private:
+      EType m_evaluator;
+      std::shared_ptr<Cache> m_cache;
+  };
+}
+
+#endif
@@ -1,38 +1,232 @@
 #ifndef COMPETITIVE_EVALUATOR_H
 #define COMPETITIVE_EVALUATOR_H
 
+#include <cmath>
+#include <array>
+#include <memory>
+#include <vector>
+#include <istream>
+#include <ostream>
 #include <functional>
 
 #include "../core/evaluator.h"
 #include "../core/candidate.h"
+#include "../core/random.h"
 #include "../core/type_traits.h"
+#include "pairing.h"
 
 namespace pr {
 
+  //! Evaluates candidates in groups of N with a user-defined contest.
+  /*!
+  *  The contest comes in one of two forms.
+  *
+  *  A Compete function receives a range of N neighbouring candidates and
+  *  assigns their fitness itself. With N = 1 the contest scores each
+  *  candidate on its own, so a fitness stays valid until the progeny
+  *  changes and only stale members are evaluated. Larger groups are
+  *  scored relative to their opponents and are evaluated every time.
+  *
+  *  A Match function instead receives a group of N candidates, laid out
+  *  by a Pairing schedule, and returns a score per member; a higher
+  *  score beats a lower one. Every evaluation plays a number of rounds
+  *  and turns the results into Elo ratings, which are kept as the fitness
+  *  -rating so that lower stays better. Members whose fitness is valid
+  *  carry their rating over from earlier generations, stale ones start
+  *  at zero. All members take part and come out valid.
+  *
+  *  Both forms run their groups on a dynamically scheduled loop, so one
+  *  long contest does not hold up a whole chunk of the population.
+  */
   template <typename CType, size_t N>
   class CompetitiveEvaluator : public Evaluator<CType> {
 
     using Population = pr::Population<CType>;
     using PopItr = typename Population::iterator;
     using Compete = typename std::function<void(PopItr, PopItr)>;
+    using FitnessType = typename CType::FitnessType;
+
+    public:
+      using Group = std::array<const CType*, N>;
+      using Scores = std::array<double, N>;
+      using Match = std::function<Scores(const Group&)>;
 
-    private:
-      
     public:
-      CompetitiveEvaluator(Compete&& c) : Evaluator<CType>(), 
+      CompetitiveEvaluator(Compete&& c) : Evaluator<CType>(),
         m_compete(std::forward<Compete>(c)) {}
 
+      /*!
+      *  \param match Scores one group.
+      *  \param pairing Schedule that forms the groups of each round.
+      *  \param rounds Rounds played per evaluation.
+      *  \param k Largest rating change from a single group.
+      */
+      template <typename PType = ShuffledPairing<N>>
+      CompetitiveEvaluator(Match match, PType pairing = PType(),
+          size_t rounds = 1, double k = 32.0) : Evaluator<CType>(),
+        m_match(std::move(match)),
+        m_pairing(std::make_shared<PType>(std::move(pairing))),
+        m_rounds(rounds), m_k(k) {
+        static_assert(N > 1, "Matches need groups of at least two.");
+        static_assert(std::is_base_of<Pairing<N>, PType>::value,
+            "The schedule must derive from Pairing<N>.");
+        static_assert(std::is_arithmetic<FitnessType>::value,
+            "Ratings need an arithmetic fitness.");
+      }
+
       virtual void evaluate(Population& pop) {
-        #pragma omp parallel for
-        for (size_t i = 0; i < pop.size() - (N - 1); i = i + N){
-          auto start = pop.begin() + i;
-          auto end = start + N;
-          m_compete(start, end);
+        if (m_match) {
+          tournament(pop, 0, pop.size(), true);
+          nextGeneration();
+          return;
+        }
+
+        if (N == 1) {
+          std::vector<size_t> indices = stale(pop);
+
+          #pragma omp parallel for schedule(dynamic)
+          for (long k = 0; k < static_cast<long>(indices.size()); k++) {
+            auto start = pop.begin() + indices[k];
+            m_compete(start, start + 1);
+            start->valid = true;
+          }
+          return;
+        }
+
+        long groups = pop.size() / N;
+
+        #pragma omp parallel for schedule(dynamic)
+        for (long g = 0; g < groups; g++) {
+          auto start = pop.begin() + g * N;
+          m_compete(start, start + N);
+        }
+      }
+
+      //! Evaluates the complete groups of N inside [first, last).
+      /*!
+      *  Groups are counted from \p first, so ranges handed to this should
+      *  start on a multiple of N to line up with evaluate(). A Match plays
+      *  its tournament among the members of the range. Ranges of the same
+      *  generation may run concurrently and share its rounds, so call
+      *  nextGeneration() once all of them have returned.
+      */
+      virtual void evaluateRange(Population& pop, size_t first, size_t last) {
+        if (m_match) {
+          tournament(pop, first, last, false);
+          return;
+        }
+
+        for (size_t i = first; i + N <= last; i = i + N) {
+          if (N == 1 && pop[i].valid) {
+            continue;
+          }
+          m_compete(pop.begin() + i, pop.begin() + i + N);
+          pop[i].valid = N == 1;
+        }
+      }
+
+      //! Moves a Match on to the rounds and pairings of the next
+      //! generation.
+      void nextGeneration() {
+        m_round += m_rounds;
+        m_random.next();
+      }
+
+      void seed(const Random& random) {
+        m_random = random;
+      }
+
+      void saveState(std::ostream& os) const {
+        m_random.saveState(os);
+        os << ' ' << m_round;
+      }
+
+      void loadState(std::istream& is) {
+        m_random.loadState(is);
+        is >> m_round;
+      }
+
+    private:
+      //! Plays m_rounds rounds among [first, last) and stores the ratings.
+      void tournament(Population& pop, size_t first, size_t last,
+          bool parallel) {
+        size_t n = last - first;
+        std::vector<double> ratings(n);
+        for (size_t i = 0; i < n; i++) {
+          const CType& cnd = pop[first + i];
+          ratings[i] = cnd.valid ? -pr::scalar(pr::fitness(cnd)) : 0;
+        }
+
+        std::vector<size_t> groups;
+        std::vector<Scores> scores;
+        std::vector<double> delta(n);
+        for (size_t r = 0; r < m_rounds; r++) {
+          RandomStream stream = m_random.stream(first * m_rounds + r);
+          m_pairing->pair(n, m_round + r, ratings, stream, groups);
+
+          long count = groups.size() / N;
+          scores.resize(count);
+
+          #pragma omp parallel for schedule(dynamic) if (parallel)
+          for (long g = 0; g < count; g++) {
+            Group group;
+            for (size_t j = 0; j < N; j++) {
+              group[j] = &pop[first + groups[g * N + j]];
+            }
+            scores[g] = m_match(group);
+          }
+
+          // Every group is rated against the ratings the round started
+          // with, so the result does not depend on the order of groups.
+          std::fill(delta.begin(), delta.end(), 0.0);
+          for (long g = 0; g < count; g++) {
+            rate(&groups[g * N], scores[g], ratings, delta);
+          }
+          for (size_t i = 0; i < n; i++) {
+            ratings[i] += delta[i];
+          }
+        }
+
+        for (size_t i = 0; i < n; i++) {
+          store(pop[first + i], ratings[i], 
+            std::is_arithmetic<FitnessType>());
+        }
+      }
+
+      void store(CType& cnd, double rating, std::true_type) {
+        pr::fitness(cnd) = static_cast<FitnessType>(-rating);
+        cnd.valid = true;
+      }
+
+      //! Never called, the Match constructor requires arithmetic fitness.
+      void store(CType&, double, std::false_type) {}
+
+      //! Elo update of one group, split into its pairwise results.
+      void rate(const size_t* members, const Scores& scores,
+          const std::vector<double>& ratings, std::vector<double>& delta) {
+        double k = m_k / (N - 1);
+        for (size_t a = 0; a < N; a++) {
+          for (size_t b = a + 1; b < N; b++) {
+            double ra = ratings[members[a]];
+            double rb = ratings[members[b]];
+            double expected = 1.0 / (1.0 + std::pow(10.0, (rb - ra) / 400.0));
+            double actual = scores[a] > scores[b] ? 1.0 :
+              scores[a] < scores[b] ? 0.0 : 0.5;
+
+            delta[members[a]] += k * (actual - expected);
+            delta[members[b]] -= k * (actual - expected);
+          }
         }
       }
 
     private:
       Compete m_compete;
+      Match m_match;
+      std::shared_ptr<const Pairing<N>> m_pairing;
+      size_t m_rounds = 1;
+      double m_k = 32.0;
+      size_t m_round = 0;
+      Random m_random;
 
   };
 }
@@ -0,0 +1,62 @@
+#ifndef HAMMING_EVALUATOR_H
+#define HAMMING_EVALUATOR_H
+
+#include <vector>
+
+#include "../core/evaluator.h"
+#include "../core/candidate.h"
+#include "../core/bit_string.h"
+
+namespace pr {
+
+  //! Evaluator that counts the bits differing from a target.
+  /*!
+  *  The error of a BitString candidate is its Hamming distance to the
+  *  target, computed a word at a time with popcount. A target of
+  *  BitString<N>::ones() gives OneMax as an error measure: N minus the
+  *  number of set bits.
+  */
+  template <typename CType>
+  class HammingEvaluator : public Evaluator<CType> {
+
+    static_assert(is_bit_string<typename CType::BaseType>::value,
+        "HammingEvaluator requires a BitString progeny.");
+
+    using Candidate = CType;
+    using Population = pr::Population<CType>;
+    using BaseType = typename CType::BaseType;
+    using FitType = typename CType::FitnessType;
+
+    public:
+      HammingEvaluator(BaseType target) : m_target(target) {}
+
+      void evaluate(Population& pop) {
+        std::vector<size_t> indices = stale(pop);
+
+        #pragma omp parallel for
+        for (long k = 0; k < static_cast<long>(indices.size()); k++) {
+          score(pop[indices[k]]);
+        }
+      }
+
+      void evaluateRange(Population& pop, size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) {
+          if (!pop[i].valid) {
+            score(pop[i]);
+          }
+        }
+      }
+
+    private:
+      void score(Candidate& cnd) const {
+        pr::fitness(cnd) = static_cast<FitType>(
+          pr::progeny(cnd).distance(m_target));
+        cnd.valid = true;
+      }
+
+    private:
+      const BaseType m_target;
+  };
+}
+
+#endif
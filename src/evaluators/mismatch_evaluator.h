@@ -1,11 +1,14 @@
 #ifndef MISMATCH_EVALUATOR_H 
 #define MISMATCH_EVALUATOR_H
 
+#include <vector>
 #include <algorithm>
 
 #include "../core/evaluator.h"
+#include "../core/delta_evaluator.h"
 #include "../core/candidate.h"
 #include "../core/type_traits.h"
+#include "../util/mismatch_kernels.h"
 
 namespace pr {
 
@@ -25,6 +28,10 @@ namespace pr {
    *
    *  If the progeny type is a statically-sized container, schedule
    *  (b) is not assessed.
+   *
+   *  Strings, vectors and arrays of one or four byte integers are scored
+   *  with the vectorized kernels of mismatch_kernels.h, MismatchBatch
+   *  candidates per pass over the target.
   */
   template <typename CType, class Enable = void>
   class MismatchEvaluator;
@@ -42,44 +49,97 @@ namespace pr {
     using Candidate = CType;
     using Population = pr::Population<CType>;
     using BaseType = typename Candidate::BaseType;
+    using FitType = typename CType::FitnessType;
 
     public:
       MismatchEvaluator(BaseType proto) : m_target(proto) {};
 
       void evaluate(Population& pop) {
+        std::vector<size_t> indices = stale(pop);
+        long batches = (indices.size() + MismatchBatch - 1) / MismatchBatch;
 
         #pragma omp parallel for
-        for (int i = 0; i < pop.size(); i++) {
+        for (long b = 0; b < batches; b++) {
+          size_t first = b * MismatchBatch;
+          score(pop, &indices[first], 
+            std::min(MismatchBatch, indices.size() - first), Vectorized());
+        }
+      }
 
-          CType& cnd = pop[i];
-          FitType error{};
+      void evaluateRange(Population& pop, size_t first, size_t last) {
+        std::vector<size_t> indices = stale(pop, first, last);
+        for (size_t k = 0; k < indices.size(); k += MismatchBatch) {
+          score(pop, &indices[k], 
+            std::min(MismatchBatch, indices.size() - k), Vectorized());
+        }
+      }
+
+    private:
+      using Vectorized = is_simd_container<BaseType>;
+
+      //! Scores up to MismatchBatch members in one pass over the target.
+      void score(Population& pop, const size_t* indices, size_t count,
+          std::true_type) {
+        using Element = typename BaseType::value_type;
+
+        // The batch shares the length every sample has in common with the 
+        // target; each sample's remainder is compared on its own.
+        const void* samples[MismatchBatch];
+        size_t counts[MismatchBatch];
+        size_t shared = m_target.size();
+        for (size_t s = 0; s < count; s++) {
+          const BaseType& sample = pr::progeny(pop[indices[s]]);
+          samples[s] = sample.data();
+          shared = std::min(shared, sample.size());
+        }
+        mismatchKernel<Element>()(m_target.data(), samples, count, shared,
+          counts);
+
+        for (size_t s = 0; s < count; s++) {
+          Candidate& cnd = pop[indices[s]];
+          const BaseType& sample = pr::progeny(cnd);
+          size_t common = std::min(m_target.size(), sample.size());
+          size_t longest = std::max(m_target.size(), sample.size());
+
+          size_t error = counts[s] + (longest - common) + countMismatches(
+            m_target.data() + shared, sample.data() + shared, 
+            common - shared);
+          pr::fitness(cnd) = static_cast<FitType>(error);
+          cnd.valid = true;
+        }
+      }
+
+      void score(Population& pop, const size_t* indices, size_t count,
+          std::false_type) {
+        for (size_t s = 0; s < count; s++) {
+          Candidate& cnd = pop[indices[s]];
+          pr::fitness(cnd) = mismatch(pr::progeny(cnd));
+          cnd.valid = true;
+        }
+      }
 
-          const BaseType& proto = m_target;
-          BaseType& sample = pr::progeny(cnd);
+      FitType mismatch(const BaseType& sample) const {
+        FitType error{};
+        const BaseType& proto = m_target;
 
-          int proto_size = proto.size();
-          int sample_size = sample.size();
+        int proto_size = proto.size();
+        int sample_size = sample.size();
 
-          // The use of #size() here is iffy. For strings, this 
-          // returns only the number of bytes in the string, whereas
-          // for vectors it returns the number of elements. For wide
-          // character encodings, this may not be reliable.
-          error += std::abs(proto_size - sample_size);
+        // The use of #size() here is iffy. For strings, this 
+        // returns only the number of bytes in the string, whereas
+        // for vectors it returns the number of elements. For wide
+        // character encodings, this may not be reliable.
+        error += std::abs(proto_size - sample_size);
 
-          int min_len = std::min(proto_size, sample_size);
-          for (int i = 0; i < min_len; i++) {
-            if (!(proto[i] == sample[i])) {
-              error += 1;
-            }
+        int min_len = std::min(proto_size, sample_size);
+        for (int i = 0; i < min_len; i++) {
+          if (!(proto[i] == sample[i])) {
+            error += 1;
           }
-          pr::fitness(cnd) = error;
         }
-
+        return error;
       }
 
-    protected:
-      typedef typename CType::FitnessType FitType;
-
     private:
       const BaseType m_target;
 
@@ -106,13 +166,22 @@ namespace pr {
       MismatchEvaluator(BaseType proto) : m_target(proto) {};
 
       void evaluate(Population& pop) {
+        std::vector<size_t> indices = stale(pop);
+        long batches = (indices.size() + MismatchBatch - 1) / MismatchBatch;
+
         #pragma omp parallel for
-        for (size_t i = 0; i < pop.size(); i++) {
+        for (long b = 0; b < batches; b++) {
+          size_t first = b * MismatchBatch;
+          score(pop, &indices[first], 
+            std::min(MismatchBatch, indices.size() - first), Vectorized());
+        }
+      }
 
-          // Since its arithmetic, should be zero-initialized.
-          FitType error{};
-          Match<Size - 1>::match(m_target, pop[i], error);
-          pr::fitness(pop[i]) = error;
+      void evaluateRange(Population& pop, size_t first, size_t last) {
+        std::vector<size_t> indices = stale(pop, first, last);
+        for (size_t k = 0; k < indices.size(); k += MismatchBatch) {
+          score(pop, &indices[k], 
+            std::min(MismatchBatch, indices.size() - k), Vectorized());
         }
       }
     
@@ -120,6 +189,41 @@ namespace pr {
       typedef typename CType::FitnessType FitType;
       static const size_t Size = std::tuple_size<BaseType>::value;
 
+    private:
+      using Vectorized = is_simd_container<BaseType>;
+
+      //! Scores up to MismatchBatch arrays in one pass over the target.
+      void score(Population& pop, const size_t* indices, size_t count,
+          std::true_type) {
+        using Element = typename BaseType::value_type;
+
+        const void* samples[MismatchBatch];
+        size_t counts[MismatchBatch];
+        for (size_t s = 0; s < count; s++) {
+          samples[s] = pr::progeny(pop[indices[s]]).data();
+        }
+        mismatchKernel<Element>()(m_target.data(), samples, count, Size,
+          counts);
+
+        for (size_t s = 0; s < count; s++) {
+          pr::fitness(pop[indices[s]]) = static_cast<FitType>(counts[s]);
+          pop[indices[s]].valid = true;
+        }
+      }
+
+      void score(Population& pop, const size_t* indices, size_t count,
+          std::false_type) {
+        for (size_t s = 0; s < count; s++) {
+          Candidate& cnd = pop[indices[s]];
+
+          // Since its arithmetic, should be zero-initialized.
+          FitType error{};
+          Match<Size - 1>::match(m_target, cnd, error);
+          pr::fitness(cnd) = error;
+          cnd.valid = true;
+        }
+      }
+
     private:
       const BaseType m_target;
   };
@@ -148,6 +252,65 @@ namespace pr {
     }
 
   };
+
+  //! MismatchEvaluator that updates the error of point mutations.
+  /*!
+  *  Assesses the same schedule as MismatchEvaluator, for arrays, vectors
+  *  and strings alike. A changed gene inside the target's length moves
+  *  the error by (new != target) - (old != target), so a member whose
+  *  change set is tracked costs O(1) per change instead of a pass over
+  *  the whole progeny; the others are scored in full with the vectorized
+  *  kernels where the genes allow.
+  */
+  template <typename CType>
+  class DeltaMismatchEvaluator : public DeltaEvaluator<CType> {
+
+    using BaseType = typename CType::BaseType;
+    using FitType = typename CType::FitnessType;
+    using Changes = typename DeltaEvaluator<CType>::Changes;
+
+    public:
+      DeltaMismatchEvaluator(BaseType proto) : m_target(proto) {}
+
+    protected:
+      FitType score(const BaseType& sample) const {
+        size_t common = std::min(m_target.size(), sample.size());
+        size_t longest = std::max(m_target.size(), sample.size());
+        return static_cast<FitType>(longest - common +
+          count(sample, common, is_simd_container<BaseType>()));
+      }
+
+      FitType delta(const BaseType& sample, FitType previous,
+          const Changes& changes) const {
+        long change = 0;
+        for (size_t k = 0; k < changes.size(); k++) {
+          size_t i = changes[k].index;
+          if (i < m_target.size()) {
+            change += !(changes.after(k, sample) == m_target[i]);
+            change -= !(changes[k].old == m_target[i]);
+          }
+        }
+        return previous + static_cast<FitType>(change);
+      }
+
+    private:
+      size_t count(const BaseType& sample, size_t n, std::true_type) const {
+        return countMismatches(m_target.data(), sample.data(), n);
+      }
+
+      size_t count(const BaseType& sample, size_t n, std::false_type) const {
+        size_t error = 0;
+        for (size_t i = 0; i < n; i++) {
+          if (!(m_target[i] == sample[i])) {
+            error++;
+          }
+        }
+        return error;
+      }
+
+    private:
+      const BaseType m_target;
+  };
 }
 
 #endif 
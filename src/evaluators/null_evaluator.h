@@ -18,6 +18,14 @@ namespace pr {
         #pragma omp parallel for
         for (size_t i = 0; i < pop.size(); i++) {
           pr::fitness(pop[i]) = FitnessType{};
+          pop[i].valid = true;
+        }
+      }
+
+      void evaluateRange(Population<CType>& pop, size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) {
+          pr::fitness(pop[i]) = FitnessType{};
+          pop[i].valid = true;
         }
       }
   };
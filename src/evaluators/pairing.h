@@ -0,0 +1,178 @@
+#ifndef PAIRING_H
+#define PAIRING_H
+
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include <random>
+
+#include "../core/random.h"
+
+namespace pr {
+
+  //! Pairing schedule of a CompetitiveEvaluator.
+  /*!
+  *  A schedule decides who meets whom in one round of a tournament. It
+  *  only lays out member indices, flattened N to a group, so candidates
+  *  are never copied or reordered to form groups. A member may appear in
+  *  several groups of a round, or in none.
+  *  \tparam N Group size.
+  */
+  template <size_t N>
+  class Pairing {
+
+    public:
+      virtual ~Pairing() = default;
+
+      /*!
+      *  \param n Number of members, indexed [0, n).
+      *  \param round Number of rounds played so far.
+      *  \param ratings Current rating of every member.
+      *  \param stream Randomness for this round.
+      *  \param groups Receives the groups of this round.
+      */
+      virtual void pair(size_t n, size_t round,
+        const std::vector<double>& ratings, RandomStream& stream,
+        std::vector<size_t>& groups) const = 0;
+
+    protected:
+      //! Groups \p order N at a time. The members left over are topped up
+      //! with opponents drawn from the rest, so everybody plays.
+      static void chunk(const std::vector<size_t>& order, RandomStream& stream,
+          std::vector<size_t>& groups) {
+        size_t n = order.size();
+        size_t full = n - n % N;
+        groups.assign(order.begin(), order.begin() + full);
+        if (full == n || n < N) {
+          return;
+        }
+
+        groups.insert(groups.end(), order.begin() + full, order.end());
+        std::uniform_int_distribution<size_t> opponent(0, full - 1);
+        for (size_t g = n - full; g < N; g++) {
+          size_t pick;
+          do {
+            pick = order[opponent(stream)];
+          } while (std::find(groups.end() - g, groups.end(), pick) !=
+            groups.end());
+          groups.push_back(pick);
+        }
+      }
+  };
+
+  //! Neighbours [i, i + N) meet, the grouping CompetitiveEvaluator has
+  //! always used. Trailing members that do not fill a group sit out.
+  template <size_t N>
+  class AdjacentPairing : public Pairing<N> {
+    public:
+      void pair(size_t n, size_t, const std::vector<double>&, RandomStream&,
+          std::vector<size_t>& groups) const {
+        groups.resize(n - n % N);
+        std::iota(groups.begin(), groups.end(), 0);
+      }
+  };
+
+  //! Groups of a fresh random permutation every round.
+  template <size_t N>
+  class ShuffledPairing : public Pairing<N> {
+    public:
+      void pair(size_t n, size_t, const std::vector<double>&,
+          RandomStream& stream, std::vector<size_t>& groups) const {
+        std::vector<size_t> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        std::shuffle(order.begin(), order.end(), stream);
+        Pairing<N>::chunk(order, stream, groups);
+      }
+  };
+
+  //! Circle-method round robin over pairs.
+  /*!
+  *  Member 0 stays put while the others rotate one seat per round, so any
+  *  n - 1 consecutive rounds (n rounded up to even) meet every pair
+  *  exactly once. With an odd count one member has a bye each round.
+  */
+  template <size_t N>
+  class RoundRobinPairing : public Pairing<N> {
+
+    static_assert(N == 2, "Round robin schedules pairs only.");
+
+    public:
+      void pair(size_t n, size_t round, const std::vector<double>&,
+          RandomStream&, std::vector<size_t>& groups) const {
+        groups.clear();
+        size_t seats = n + n % 2;
+        if (seats < 2) {
+          return;
+        }
+
+        size_t turns = seats - 1;
+        auto seat = [&](size_t s) {
+          return s == 0 ? 0 : 1 + (s - 1 + round) % turns;
+        };
+        for (size_t s = 0; s < seats / 2; s++) {
+          size_t a = seat(s);
+          size_t b = seat(seats - 1 - s);
+          if (a < n && b < n) {
+            groups.push_back(a);
+            groups.push_back(b);
+          }
+        }
+      }
+  };
+
+  //! Swiss system: members of similar rating meet.
+  /*!
+  *  Members are shuffled, stably sorted by rating and grouped in that
+  *  order, so ties are broken at random. Unlike a chess Swiss, repeated
+  *  meetings are not avoided, as no history is kept.
+  */
+  template <size_t N>
+  class SwissPairing : public Pairing<N> {
+    public:
+      void pair(size_t n, size_t, const std::vector<double>& ratings,
+          RandomStream& stream, std::vector<size_t>& groups) const {
+        std::vector<size_t> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        std::shuffle(order.begin(), order.end(), stream);
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+          return ratings[a] > ratings[b];
+        });
+        Pairing<N>::chunk(order, stream, groups);
+      }
+  };
+
+  //! Every member meets K groups of N - 1 random distinct opponents.
+  template <size_t N>
+  class RandomOpponentsPairing : public Pairing<N> {
+    public:
+      explicit RandomOpponentsPairing(size_t k) : m_k(k) {}
+
+      void pair(size_t n, size_t, const std::vector<double>&,
+          RandomStream& stream, std::vector<size_t>& groups) const {
+        groups.clear();
+        if (n < N) {
+          return;
+        }
+
+        std::uniform_int_distribution<size_t> opponent(0, n - 1);
+        for (size_t i = 0; i < n; i++) {
+          for (size_t k = 0; k < m_k; k++) {
+            groups.push_back(i);
+            for (size_t g = 1; g < N; g++) {
+              size_t pick;
+              do {
+                pick = opponent(stream);
+              } while (std::find(groups.end() - g, groups.end(), pick) !=
+                groups.end());
+              groups.push_back(pick);
+            }
+          }
+        }
+      }
+
+    private:
+      size_t m_k;
+  };
+}
+
+#endif
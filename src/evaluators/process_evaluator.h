@@ -0,0 +1,443 @@
+#ifndef PROCESS_EVALUATOR_H
+#define PROCESS_EVALUATOR_H
+
+#include <deque>
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "../core/evaluator.h"
+#include "../core/candidate.h"
+#include "../util/process_worker.h"
+
+extern char** environ;
+
+namespace pr {
+
+  //! Evaluates candidates in a pool of long-lived worker processes.
+  /*!
+  *  For fitness functions that live in another binary or have to run
+  *  isolated. The workers are started once and serve batches until the
+  *  evaluator goes away; see serveWorker() for the worker side.
+  *
+  *  Stale genomes are packed a batch at a time into slots of a memory
+  *  region shared with all workers, and fitness values come back through
+  *  the same slots, so nothing is serialized and only slot indices travel
+  *  over each worker's socket. There are depth slots per worker: while a
+  *  worker scores one batch the next is already queued for it, and the
+  *  evaluator packs further batches and unpacks finished ones meanwhile.
+  *
+  *  A worker that exits or crashes with batches pending is restarted and
+  *  its batches are queued again, from the slots they still occupy. A
+  *  batch that has crashed more than \p retries workers is given up on
+  *  with a std::runtime_error, and the workers still busy with that call
+  *  are stopped; the next call starts them again.
+  *
+  *  Copies of a ProcessEvaluator share one pool. Calls are serialized,
+  *  so concurrent evaluateRange() calls take turns on the whole pool.
+  *  POSIX only.
+  *  \tparam CType The candidate type; progeny and fitness must be
+  *  trivially copyable.
+  */
+  template <typename CType>
+  class ProcessEvaluator : public Evaluator<CType> {
+
+    using Population = pr::Population<CType>;
+    using BaseType = typename CType::BaseType;
+    using FitnessType = typename CType::FitnessType;
+
+    static_assert(std::is_trivially_copyable<BaseType>::value &&
+        std::is_trivially_copyable<FitnessType>::value,
+        "ProcessEvaluator requires trivially copyable progeny and fitness.");
+
+    public:
+      /*!
+      *  \param command Path of the worker executable, then its arguments.
+      *  The path is not looked up in PATH.
+      *  \param workers Number of worker processes.
+      *  \param batch Genomes per batch.
+      *  \param depth Batches queued per worker.
+      *  \param retries Restarts a single batch may cause.
+      */
+      ProcessEvaluator(std::vector<std::string> command, size_t workers = 4,
+          size_t batch = 64, size_t depth = 2, size_t retries = 3) :
+        Evaluator<CType>(), m_pool(std::make_shared<Pool>(std::move(command),
+          std::max<size_t>(workers, 1), std::max<size_t>(batch, 1),
+          std::max<size_t>(depth, 1), retries)) {}
+
+      void evaluate(Population& pop) {
+        evaluateRange(pop, 0, pop.size());
+      }
+
+      void evaluateRange(Population& pop, size_t first, size_t last) {
+        m_pool->run(pop, stale(pop, first, last));
+      }
+
+      //! Number of workers restarted so far.
+      size_t restarts() const {
+        return m_pool->restarts();
+      }
+
+    private:
+      class Pool {
+
+        struct Worker {
+          pid_t pid = -1;
+          int socket = -1;
+          std::deque<uint32_t> pending;
+        };
+
+        struct Slot {
+          size_t batch = 0;
+          size_t attempts = 0;
+        };
+
+        public:
+          Pool(std::vector<std::string> command, size_t workers,
+              size_t batch, size_t depth, size_t retries) :
+            m_command(std::move(command)), m_workers(workers),
+            m_layout(sizeof(BaseType), sizeof(FitnessType), batch,
+              workers * depth),
+            m_slots(workers * depth), m_depth(depth), m_retries(retries) {
+            if (m_command.empty()) {
+              throw std::invalid_argument("No worker command given");
+            }
+
+            createRegion();
+            buildEnvironment();
+            for (auto& w : m_workers) {
+              spawn(w);
+            }
+          }
+
+          ~Pool() {
+            for (auto& w : m_workers) {
+              stop(w);
+            }
+            ::munmap(m_region, m_layout.size());
+            ::close(m_fd);
+          }
+
+          Pool(const Pool&) = delete;
+          Pool& operator=(const Pool&) = delete;
+
+          size_t restarts() const {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_restarts;
+          }
+
+          //! Scores the members \p indices of \p pop.
+          void run(Population& pop, const std::vector<size_t>& indices) {
+            std::lock_guard<std::mutex> lock(m_lock);
+
+            size_t capacity = m_layout.capacity;
+            size_t batches = (indices.size() + capacity - 1) / capacity;
+            size_t packed = 0;
+            size_t done = 0;
+
+            std::vector<uint32_t> idle(m_slots.size());
+            for (size_t s = 0; s < idle.size(); s++) {
+              idle[s] = idle.size() - 1 - s;
+            }
+            std::deque<uint32_t> ready;
+
+            try {
+              // Workers halted by a failed call start again here.
+              for (auto& w : m_workers) {
+                if (w.socket < 0) {
+                  spawn(w);
+                  m_restarts++;
+                }
+              }
+
+              while (done < batches) {
+                while (!idle.empty() && packed < batches) {
+                  uint32_t s = idle.back();
+                  idle.pop_back();
+                  pack(pop, indices, packed++, s);
+                  ready.push_back(s);
+                }
+
+                dispatch(ready);
+                for (uint32_t s : collect(ready)) {
+                  unpack(pop, indices, s);
+                  idle.push_back(s);
+                  done++;
+                }
+              }
+            } catch (...) {
+              // A worker still holding slots would read them while the
+              // next call repacks them, and answer it with stale replies.
+              for (auto& w : m_workers) {
+                if (!w.pending.empty()) {
+                  halt(w);
+                }
+              }
+              throw;
+            }
+          }
+
+        private:
+          void createRegion() {
+            // The name only lives until the descriptor is open, so the
+            // memory goes away with the last process that maps it.
+            static std::atomic<unsigned> counter{0};
+            std::string name = "/progeny-" + std::to_string(::getpid()) +
+              "-" + std::to_string(counter++);
+
+            m_fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+            if (m_fd < 0) {
+              throw std::runtime_error("Cannot create shared memory " + name);
+            }
+            ::shm_unlink(name.c_str());
+
+            // Workers inherit the descriptor through exec.
+            ::fcntl(m_fd, F_SETFD, 0);
+            if (::ftruncate(m_fd, m_layout.size()) != 0) {
+              ::close(m_fd);
+              throw std::runtime_error("Cannot size shared memory " + name);
+            }
+
+            void* map = ::mmap(nullptr, m_layout.size(),
+              PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+            if (map == MAP_FAILED) {
+              ::close(m_fd);
+              throw std::runtime_error("Cannot map shared memory " + name);
+            }
+            m_region = static_cast<char*>(map);
+            std::memcpy(m_region, &m_layout, sizeof(m_layout));
+          }
+
+          //! Prepares argv and envp up front: between fork and exec only
+          //! async-signal-safe calls are allowed, so no allocation.
+          void buildEnvironment() {
+            for (auto& arg : m_command) {
+              m_argv.push_back(&arg[0]);
+            }
+            m_argv.push_back(nullptr);
+
+            std::string prefix = std::string(ProcessShmVariable) + "=";
+            m_shm_entry = prefix + std::to_string(m_fd);
+            for (char** e = environ; *e; e++) {
+              if (std::strncmp(*e, prefix.c_str(), prefix.size()) != 0) {
+                m_envp.push_back(*e);
+              }
+            }
+            m_envp.push_back(&m_shm_entry[0]);
+            m_envp.push_back(nullptr);
+          }
+
+          void spawn(Worker& w) {
+            int fds[2];
+            if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds)) {
+              throw std::runtime_error("Cannot create worker socket");
+            }
+
+            pid_t pid = ::fork();
+            if (pid < 0) {
+              ::close(fds[0]);
+              ::close(fds[1]);
+              throw std::runtime_error("Cannot fork worker");
+            }
+
+            if (pid == 0) {
+              // dup2 leaves the copies open across exec.
+              ::dup2(fds[1], STDIN_FILENO);
+              ::dup2(fds[1], STDOUT_FILENO);
+              ::execve(m_argv[0], m_argv.data(), m_envp.data());
+              ::_exit(127);
+            }
+
+            ::close(fds[1]);
+            w.pid = pid;
+            w.socket = fds[0];
+            w.pending.clear();
+          }
+
+          void stop(Worker& w) {
+            if (w.socket >= 0) {
+              // Hanging up ends the worker's loop.
+              ::close(w.socket);
+              w.socket = -1;
+            }
+            if (w.pid > 0) {
+              int status;
+              while (::waitpid(w.pid, &status, 0) < 0 && errno == EINTR) {}
+              w.pid = -1;
+            }
+          }
+
+          //! Kills \p w and forgets its batches; the next run() starts it
+          //! again.
+          void halt(Worker& w) {
+            if (w.pid > 0) {
+              ::kill(w.pid, SIGKILL);
+            }
+            stop(w);
+            w.pending.clear();
+          }
+
+          //! Hands ready slots to live workers with room in their queue.
+          void dispatch(std::deque<uint32_t>& ready) {
+            for (size_t q = 0; !ready.empty() && q < m_depth; q++) {
+              for (auto& w : m_workers) {
+                if (ready.empty()) {
+                  break;
+                }
+                if (w.socket < 0 || w.pending.size() > q) {
+                  continue;
+                }
+
+                uint32_t s = ready.front();
+                ready.pop_front();
+                w.pending.push_back(s);
+                if (::send(w.socket, &s, sizeof(s), MSG_NOSIGNAL) !=
+                    static_cast<ssize_t>(sizeof(s))) {
+                  recover(w, ready);
+                }
+              }
+            }
+          }
+
+          //! Waits for replies and returns the slots that came back.
+          std::vector<uint32_t> collect(std::deque<uint32_t>& ready) {
+            std::vector<pollfd> fds;
+            std::vector<Worker*> owners;
+            for (auto& w : m_workers) {
+              if (w.socket >= 0 && !w.pending.empty()) {
+                fds.push_back(pollfd{ w.socket, POLLIN, 0 });
+                owners.push_back(&w);
+              }
+            }
+
+            std::vector<uint32_t> finished;
+            if (fds.empty()) {
+              return finished;
+            }
+
+            int n = ::poll(fds.data(), fds.size(), -1);
+            if (n < 0) {
+              if (errno == EINTR) {
+                return finished;
+              }
+              throw std::runtime_error("Cannot poll workers");
+            }
+
+            for (size_t k = 0; k < fds.size(); k++) {
+              if (!fds[k].revents) {
+                continue;
+              }
+
+              Worker& w = *owners[k];
+              uint32_t replies[65];
+              ssize_t bytes = ::recv(w.socket, replies, 64 * sizeof(uint32_t),
+                MSG_DONTWAIT);
+              if (bytes < 0 && (errno == EAGAIN || errno == EINTR)) {
+                continue;
+              }
+
+              // A reply split across reads is completed before going on.
+              size_t partial = bytes > 0 ? bytes % sizeof(uint32_t) : 0;
+              if (bytes <= 0 || (partial && !readFully(w.socket, 
+                  reinterpret_cast<char*>(replies) + bytes, 
+                  sizeof(uint32_t) - partial))) {
+                recover(w, ready);
+                continue;
+              }
+              bytes += partial ? sizeof(uint32_t) - partial : 0;
+
+              for (ssize_t r = 0; r < bytes / 4; r++) {
+                // Workers answer in order.
+                w.pending.pop_front();
+                finished.push_back(replies[r]);
+              }
+            }
+            return finished;
+          }
+
+          //! Restarts a dead worker and queues its batches again.
+          void recover(Worker& w, std::deque<uint32_t>& ready) {
+            for (auto it = w.pending.rbegin(); it != w.pending.rend(); it++) {
+              if (++m_slots[*it].attempts > m_retries) {
+                throw std::runtime_error("Batch failed on " +
+                  std::to_string(m_retries + 1) + " workers: " +
+                  m_command[0]);
+              }
+              ready.push_front(*it);
+            }
+            w.pending.clear();
+
+            halt(w);
+            spawn(w);
+            m_restarts++;
+          }
+
+          void pack(const Population& pop, const std::vector<size_t>& indices,
+              size_t batch, uint32_t s) {
+            char* slot = m_layout.slot(m_region, s);
+            size_t first = batch * m_layout.capacity;
+            size_t count = std::min<size_t>(m_layout.capacity,
+              indices.size() - first);
+
+            *reinterpret_cast<uint64_t*>(slot) = count;
+            char* genomes = slot + m_layout.genomeOffset;
+            for (size_t b = 0; b < count; b++) {
+              std::memcpy(genomes + b * sizeof(BaseType),
+                &pr::progeny(pop[indices[first + b]]), sizeof(BaseType));
+            }
+            m_slots[s].batch = batch;
+            m_slots[s].attempts = 0;
+          }
+
+          void unpack(Population& pop, const std::vector<size_t>& indices,
+              uint32_t s) {
+            char* slot = m_layout.slot(m_region, s);
+            size_t first = m_slots[s].batch * m_layout.capacity;
+            size_t count = *reinterpret_cast<uint64_t*>(slot);
+
+            const char* fitness = slot + m_layout.fitnessOffset;
+            for (size_t b = 0; b < count; b++) {
+              CType& cnd = pop[indices[first + b]];
+              std::memcpy(&pr::fitness(cnd), fitness + b * sizeof(FitnessType),
+                sizeof(FitnessType));
+              cnd.valid = true;
+            }
+          }
+
+        private:
+          std::vector<std::string> m_command;
+          std::vector<Worker> m_workers;
+          ProcessLayout m_layout;
+          std::vector<Slot> m_slots;
+          size_t m_depth;
+          size_t m_retries;
+          size_t m_restarts = 0;
+          int m_fd = -1;
+          char* m_region = nullptr;
+          std::vector<char*> m_argv;
+          std::vector<char*> m_envp;
+          std::string m_shm_entry;
+          mutable std::mutex m_lock;
+      };
+
+    private:
+      std::shared_ptr<Pool> m_pool;
+  };
+}
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef QUEENS_EVALUATOR_H
+#define QUEENS_EVALUATOR_H
+
+#include <vector>
+#include <type_traits>
+
+#include "../core/delta_evaluator.h"
+
+namespace pr {
+
+  //! Counts the pairs of attacking queens on a Q x Q board.
+  /*!
+  *  Gene c is the row of the queen in column c, in [0, Q). The full score
+  *  counts the queens on every row and diagonal, so it is O(Q) rather
+  *  than the O(Q^2) of checking every pair. Moving one queen changes only
+  *  the pairs that queen is part of, so the incremental update compares
+  *  each moved queen's old and new square against the other columns,
+  *  O(Q) per move. Neither allocates: the full score counts into a
+  *  per-thread buffer, and the update reads the squares of queens that
+  *  moved later from the change set instead of replaying a copied board.
+  *  \tparam CType The candidate type, whose progeny is a container of
+  *  integer rows and whose fitness is arithmetic.
+  */
+  template <typename CType>
+  class QueensEvaluator : public DeltaEvaluator<CType> {
+
+    using BaseType = typename CType::BaseType;
+    using FitnessType = typename CType::FitnessType;
+    using Changes = typename DeltaEvaluator<CType>::Changes;
+
+    static_assert(std::is_integral<typename BaseType::value_type>::value &&
+        std::is_arithmetic<FitnessType>::value,
+        "QueensEvaluator requires integer rows and an arithmetic fitness.");
+
+    protected:
+      FitnessType score(const BaseType& board) const {
+        long q = board.size();
+
+        // Rows, then diagonals r - c + q - 1, then antidiagonals r + c.
+        static thread_local std::vector<long> lines;
+        lines.assign(5 * q, 0);
+        for (long c = 0; c < q; c++) {
+          long r = board[c];
+          lines[r]++;
+          lines[q + r - c + q - 1]++;
+          lines[3 * q + r + c]++;
+        }
+
+        long attacks = 0;
+        for (long n : lines) {
+          attacks += n * (n - 1) / 2;
+        }
+        return static_cast<FitnessType>(attacks);
+      }
+
+      FitnessType delta(const BaseType& board, FitnessType previous,
+          const Changes& changes) const {
+        // Undo the moves last to first, each against the board as it was
+        // right after it.
+        long change = 0;
+        for (size_t k = changes.size(); k-- > 0;) {
+          long c = changes[k].index;
+          change += attacks(board, changes, k, c, changes.after(k, board)) -
+            attacks(board, changes, k, c, changes[k].old);
+        }
+        return previous + static_cast<FitnessType>(change);
+      }
+
+    private:
+      //! Queens outside column \p c that attack square (\p r, \p c).
+      static long attacks(const BaseType& board, long c, long r) {
+        long q = board.size();
+        long count = 0;
+        for (long j = 0; j < c; j++) {
+          long d = board[j] - r;
+          count += (d == 0) | (d == c - j) | (d == j - c);
+        }
+        for (long j = c + 1; j < q; j++) {
+          long d = board[j] - r;
+          count += (d == 0) | (d == j - c) | (d == c - j);
+        }
+        return count;
+      }
+
+      //! attacks() against the board as it was right after change \p k:
+      //! a column moved again later still held the old row of the first
+      //! of those later changes.
+      static long attacks(const BaseType& board, const Changes& changes,
+          size_t k, long c, long r) {
+        long count = attacks(board, c, r);
+        for (size_t m = k + 1; m < changes.size(); m++) {
+          long j = changes[m].index;
+          bool first = j != c;
+          for (size_t l = k + 1; first && l < m; l++) {
+            first = changes[l].index != j;
+          }
+          if (first) {
+            count += hit(j, changes[m].old, c, r) - hit(j, board[j], c, r);
+          }
+        }
+        return count;
+      }
+
+      //! Whether a queen at (\p row, \p j) attacks square (\p r, \p c).
+      static long hit(long j, long row, long c, long r) {
+        long d = row - r;
+        return (d == 0) | (d == j - c) | (d == c - j);
+      }
+  };
+}
+
+#endif
@@ -0,0 +1,170 @@
+#ifndef RACING_EVALUATOR_H
+#define RACING_EVALUATOR_H
+
+#include <mutex>
+#include <limits>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <omp.h>
+
+#include "../core/evaluator.h"
+#include "../core/candidate.h"
+
+namespace pr {
+
+  //! The running evaluation of one candidate against the threshold.
+  /*!
+  *  A fitness function that accumulates error, e.g. over test cases,
+  *  calls lost() every so often with the error so far. Once that exceeds
+  *  the threshold the candidate cannot survive, lost() returns true and
+  *  the function should return the error so far right away.
+  */
+  class Race {
+
+    public:
+      explicit Race(double threshold) : m_threshold(threshold) {}
+
+      /*!
+      *  \param partial The error so far, a lower bound on the final one.
+      *  \param progress The share of the work done so far, in [0, 1].
+      *  \returns Whether to stop.
+      */
+      bool lost(double partial, double progress) {
+        if (!(partial > m_threshold)) {
+          return false;
+        }
+        m_saved = 1.0 - std::min(std::max(progress, 0.0), 1.0);
+        m_aborted = true;
+        return true;
+      }
+
+      double threshold() const { return m_threshold; }
+
+      bool aborted() const { return m_aborted; }
+
+      //! The share of the work that was skipped.
+      double saved() const { return m_saved; }
+
+    private:
+      double m_threshold;
+      double m_saved = 0.0;
+      bool m_aborted = false;
+  };
+
+  //! Evaluator that gives up on candidates that cannot survive.
+  /*!
+  *  The fitness function gets a Race with every candidate and checks it
+  *  periodically, returning its partial error once the race is lost. The
+  *  threshold comes from the simulation (see ProtoSimulation::racing()),
+  *  which publishes it before every evaluation, and is infinite until
+  *  then, so nothing is abandoned.
+  *
+  *  An abandoned candidate keeps its partial error as its fitness, a lower
+  *  bound that already exceeds the threshold, so it ranks behind those
+  *  that made it. It is marked estimated and stays stale, like a
+  *  SurrogateEvaluator prediction, since selectors that do not truncate
+  *  may still keep it. Its change set starts over empty, so a survivor
+  *  that no operator changed since is scored in full, without a
+  *  threshold, at the next evaluation rather than living on with an
+  *  understated error. Progeny without a change set race again.
+  *  \tparam CType The candidate type, with arithmetic fitness.
+  */
+  template <typename CType>
+  class RacingEvaluator : public Evaluator<CType> {
+
+    using Population = pr::Population<CType>;
+    using BaseType = typename CType::BaseType;
+    using FitnessType = typename CType::FitnessType;
+
+    static_assert(std::is_arithmetic<FitnessType>::value,
+        "RacingEvaluator requires an arithmetic fitness.");
+
+    public:
+      using Score = std::function<FitnessType(const BaseType&, Race&)>;
+
+    public:
+      RacingEvaluator(Score score) : Evaluator<CType>(),
+        m_score(std::move(score)), m_shared(std::make_shared<Shared>()) {}
+
+      void evaluate(Population& pop) {
+        std::vector<size_t> indices = stale(pop);
+        size_t aborted = 0;
+        double saved = 0;
+
+        #pragma omp parallel for schedule(dynamic) reduction(+:aborted,saved)
+        for (long k = 0; k < static_cast<long>(indices.size()); k++) {
+          Race race = this->race(pop[indices[k]]);
+          run(pop[indices[k]], race);
+          aborted += race.aborted();
+          saved += race.saved();
+        }
+        record(indices.size(), aborted, saved);
+      }
+
+      void evaluateRange(Population& pop, size_t first, size_t last) {
+        std::vector<size_t> indices = stale(pop, first, last);
+        size_t aborted = 0;
+        double saved = 0;
+        for (size_t i : indices) {
+          Race race = this->race(pop[i]);
+          run(pop[i], race);
+          aborted += race.aborted();
+          saved += race.saved();
+        }
+        record(indices.size(), aborted, saved);
+      }
+
+      //! Sets the error beyond which candidates are abandoned.
+      void threshold(double value) {
+        m_threshold = value;
+      }
+
+      RaceStats raceStats() const {
+        std::lock_guard<std::mutex> lock(m_shared->lock);
+        RaceStats stats = m_shared->stats;
+        stats.threshold = m_threshold;
+        return stats;
+      }
+
+    private:
+      struct Shared {
+        RaceStats stats;
+        std::mutex lock;
+      };
+
+      void run(CType& cnd, Race& race) {
+        pr::fitness(cnd) = m_score(pr::progeny(cnd), race);
+        cnd.valid = !race.aborted();
+        cnd.estimated = race.aborted();
+        if (race.aborted()) {
+          cnd.changes.reset();
+        }
+      }
+
+      //! The race for \p cnd: an abandoned candidate that is back
+      //! unchanged runs to the end.
+      Race race(const CType& cnd) const {
+        bool unchanged = cnd.changes.tracked() && cnd.changes.size() == 0;
+        return Race(cnd.estimated && unchanged ?
+          std::numeric_limits<double>::infinity() : m_threshold);
+      }
+
+      void record(size_t evaluations, size_t aborted, double saved) {
+        std::lock_guard<std::mutex> lock(m_shared->lock);
+        m_shared->stats.evaluations += evaluations;
+        m_shared->stats.aborted += aborted;
+        m_shared->stats.savedWork += saved;
+      }
+
+    private:
+      Score m_score;
+      double m_threshold = std::numeric_limits<double>::infinity();
+      // Shared by copies and updated once per call, as evaluateRange()
+      // runs on several threads at once.
+      std::shared_ptr<Shared> m_shared;
+  };
+}
+
+#endif
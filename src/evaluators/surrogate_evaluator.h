@@ -0,0 +1,421 @@
+#ifndef SURROGATE_EVALUATOR_H
+#define SURROGATE_EVALUATOR_H
+
+#include <cmath>
+#include <mutex>
+#include <array>
+#include <memory>
+#include <vector>
+#include <limits>
+#include <numeric>
+#include <istream>
+#include <ostream>
+#include <iterator>
+#include <algorithm>
+#include <omp.h>
+
+#include "../core/evaluator.h"
+#include "../core/candidate.h"
+#include "../core/random.h"
+#include "../core/serialization.h"
+#include "../core/type_traits.h"
+
+namespace pr {
+
+  //! Writes \p values as text that reads back to the same doubles.
+  inline void saveDoubles(std::ostream& os, const std::vector<double>& values) {
+    std::streamsize precision = os.precision(
+      std::numeric_limits<double>::max_digits10);
+    os << values.size();
+    for (double v : values) {
+      os << ' ' << v;
+    }
+    os.precision(precision);
+  }
+
+  inline void loadDoubles(std::istream& is, std::vector<double>& values) {
+    size_t size = 0;
+    is >> std::ws >> size;
+    values.resize(size);
+    for (double& v : values) {
+      is >> std::ws >> v;
+    }
+  }
+
+  //! k-nearest-neighbour fitness model over the most recent samples.
+  /*!
+  *  Remembers the last \p capacity evaluated genomes in a ring and
+  *  predicts the inverse-distance weighted mean fitness of the k closest
+  *  of them. Updating is O(N), predicting O(capacity N).
+  *  \tparam BaseType A std::array of arithmetic genes.
+  */
+  template <typename BaseType>
+  class KnnSurrogate {
+
+    static_assert(is_std_array<BaseType>::value &&
+        std::is_arithmetic<typename BaseType::value_type>::value,
+        "KnnSurrogate requires std::array genomes of arithmetic genes.");
+
+    static const size_t N = std::tuple_size<BaseType>::value;
+
+    public:
+      KnnSurrogate(size_t k = 5, size_t capacity = 1024) :
+        m_k(std::max<size_t>(k, 1)),
+        m_capacity(std::max<size_t>(capacity, m_k)) {}
+
+      void update(const BaseType& genome, double fitness) {
+        if (m_fitness.size() < m_capacity) {
+          m_genes.insert(m_genes.end(), genome.begin(), genome.end());
+          m_fitness.push_back(fitness);
+          return;
+        }
+
+        std::copy(genome.begin(), genome.end(), &m_genes[m_next * N]);
+        m_fitness[m_next] = fitness;
+        m_next = (m_next + 1) % m_capacity;
+      }
+
+      double predict(const BaseType& genome) const {
+        // The k best so far, kept sorted by distance.
+        std::vector<std::pair<double, double>> best;
+        best.reserve(m_k + 1);
+
+        for (size_t s = 0; s < m_fitness.size(); s++) {
+          const double* genes = &m_genes[s * N];
+          double d = 0;
+          for (size_t j = 0; j < N; j++) {
+            double diff = genes[j] - static_cast<double>(genome[j]);
+            d += diff * diff;
+          }
+          if (best.size() == m_k && d >= best.back().first) {
+            continue;
+          }
+
+          auto at = std::upper_bound(best.begin(), best.end(),
+            std::make_pair(d, 0.0), [](const std::pair<double, double>& a,
+              const std::pair<double, double>& b) {
+            return a.first < b.first;
+          });
+          best.insert(at, std::make_pair(d, m_fitness[s]));
+          if (best.size() > m_k) {
+            best.pop_back();
+          }
+        }
+
+        if (!best.empty() && best.front().first == 0) {
+          return best.front().second;
+        }
+
+        double weights = 0;
+        double sum = 0;
+        for (auto& b : best) {
+          double w = 1.0 / std::sqrt(b.first);
+          weights += w;
+          sum += w * b.second;
+        }
+        return weights > 0 ? sum / weights : 0;
+      }
+
+      bool ready() const {
+        return m_fitness.size() >= m_k;
+      }
+
+      //! Saves the remembered samples.
+      void saveState(std::ostream& os) const {
+        os << m_next << ' ';
+        saveDoubles(os, m_genes);
+        os << ' ';
+        saveDoubles(os, m_fitness);
+      }
+
+      void loadState(std::istream& is) {
+        is >> std::ws >> m_next;
+        loadDoubles(is, m_genes);
+        loadDoubles(is, m_fitness);
+      }
+
+    private:
+      size_t m_k;
+      size_t m_capacity;
+      size_t m_next = 0;
+      std::vector<double> m_genes;
+      std::vector<double> m_fitness;
+  };
+
+  //! Online linear fitness model, fitted by recursive least squares.
+  /*!
+  *  Fits fitness = w . genes + b, updating the exact least squares
+  *  solution with every sample in O(N^2) instead of refitting. A
+  *  forgetting factor below one discounts old samples geometrically, so
+  *  the model follows a population that moves on.
+  *  \tparam BaseType A std::array of arithmetic genes.
+  */
+  template <typename BaseType>
+  class LinearSurrogate {
+
+    static_assert(is_std_array<BaseType>::value &&
+        std::is_arithmetic<typename BaseType::value_type>::value,
+        "LinearSurrogate requires std::array genomes of arithmetic genes.");
+
+    // The genes plus a constant input for the intercept.
+    static const size_t D = std::tuple_size<BaseType>::value + 1;
+
+    public:
+      /*!
+      *  \param forgetting Weight of the previous samples at each update.
+      *  \param prior Initial variance of the weights; large values let
+      *  the first samples decide.
+      */
+      LinearSurrogate(double forgetting = 0.99, double prior = 1e3) :
+        m_lambda(forgetting), m_weights(D, 0.0), m_cov(D * D, 0.0) {
+        for (size_t i = 0; i < D; i++) {
+          m_cov[i * D + i] = prior;
+        }
+      }
+
+      void update(const BaseType& genome, double fitness) {
+        double x[D];
+        features(genome, x);
+
+        // gain = P x / (lambda + x' P x)
+        double px[D];
+        double xpx = 0;
+        for (size_t i = 0; i < D; i++) {
+          px[i] = 0;
+          for (size_t j = 0; j < D; j++) {
+            px[i] += m_cov[i * D + j] * x[j];
+          }
+          xpx += x[i] * px[i];
+        }
+
+        double error = fitness - dot(x);
+        double scale = 1.0 / (m_lambda + xpx);
+        for (size_t i = 0; i < D; i++) {
+          m_weights[i] += px[i] * scale * error;
+        }
+
+        // P = (P - gain (P x)') / lambda, with P symmetric.
+        for (size_t i = 0; i < D; i++) {
+          for (size_t j = 0; j < D; j++) {
+            m_cov[i * D + j] = (m_cov[i * D + j] - px[i] * px[j] * scale) /
+              m_lambda;
+          }
+        }
+        m_samples++;
+      }
+
+      double predict(const BaseType& genome) const {
+        double x[D];
+        features(genome, x);
+        return dot(x);
+      }
+
+      //! Ready once there were as many samples as weights.
+      bool ready() const {
+        return m_samples >= D;
+      }
+
+      //! Saves the fitted weights and their covariance.
+      void saveState(std::ostream& os) const {
+        os << m_samples << ' ';
+        saveDoubles(os, m_weights);
+        os << ' ';
+        saveDoubles(os, m_cov);
+      }
+
+      void loadState(std::istream& is) {
+        is >> std::ws >> m_samples;
+        loadDoubles(is, m_weights);
+        loadDoubles(is, m_cov);
+      }
+
+    private:
+      static void features(const BaseType& genome, double* x) {
+        std::copy(genome.begin(), genome.end(), x);
+        x[D - 1] = 1.0;
+      }
+
+      double dot(const double* x) const {
+        return std::inner_product(x, x + D, m_weights.begin(), 0.0);
+      }
+
+    private:
+      double m_lambda;
+      size_t m_samples = 0;
+      std::vector<double> m_weights;
+      std::vector<double> m_cov;
+  };
+
+  //! Pre-screens stale candidates with a cheap model of the fitness.
+  /*!
+  *  The model predicts the fitness of every stale member, and only the
+  *  most promising fraction, the ones with the lowest predicted error as
+  *  the simulation minimizes, is handed to the wrapped evaluator. Their
+  *  real fitness trains the model. The others keep the prediction and are
+  *  marked estimated; they stay stale, so they are screened again, by a
+  *  better trained model, at the next evaluation. Until the model is ready
+  *  every stale member gets a real evaluation.
+  *
+  *  A model provides update(genome, fitness), predict(genome) and
+  *  ready(); see KnnSurrogate and LinearSurrogate. Predictions run in
+  *  parallel, updates serially. Copies of a SurrogateEvaluator share one
+  *  model. Checkpoints save the model, if it has saveState() and
+  *  loadState(), along with the counters.
+  *  \tparam CType The candidate type, with arithmetic fitness.
+  *  \tparam EType The wrapped, expensive evaluator.
+  *  \tparam MType The model.
+  */
+  template <typename CType, typename EType, typename MType>
+  class SurrogateEvaluator : public Evaluator<CType> {
+
+    using Population = pr::Population<CType>;
+    using FitnessType = typename CType::FitnessType;
+
+    static_assert(std::is_arithmetic<FitnessType>::value,
+        "SurrogateEvaluator requires an arithmetic fitness.");
+
+    public:
+      /*!
+      *  \param evaluator The expensive evaluator.
+      *  \param model The surrogate, possibly trained already.
+      *  \param fraction Share of the stale members evaluated for real,
+      *  at least one per call.
+      */
+      SurrogateEvaluator(EType evaluator, MType model, double fraction = 0.25) :
+        Evaluator<CType>(), m_evaluator(std::move(evaluator)),
+        m_shared(std::make_shared<Shared>(std::move(model))),
+        m_fraction(fraction) {}
+
+      void evaluate(Population& pop) {
+        screen(pop, stale(pop), [this](Population& batch) {
+          m_evaluator.evaluate(batch);
+        });
+      }
+
+      void evaluateRange(Population& pop, size_t first, size_t last) {
+        screen(pop, stale(pop, first, last), [this](Population& batch) {
+          m_evaluator.evaluateRange(batch, 0, batch.size());
+        });
+      }
+
+      bool isNatural() {
+        return m_evaluator.isNatural();
+      }
+
+      //! Members handed to the wrapped evaluator so far.
+      size_t realEvaluations() const {
+        std::lock_guard<std::mutex> lock(m_shared->lock);
+        return m_shared->real;
+      }
+
+      //! Members that were given a predicted fitness so far.
+      size_t estimates() const {
+        std::lock_guard<std::mutex> lock(m_shared->lock);
+        return m_shared->estimated;
+      }
+
+      void nextGeneration() {
+        pr::nextGeneration(m_evaluator);
+      }
+
+      void seed(const Random& random) {
+        pr::seed(m_evaluator, random);
+      }
+
+      void saveState(std::ostream& os) const {
+        pr::saveState(m_evaluator, os);
+        os << ' ';
+        std::lock_guard<std::mutex> lock(m_shared->lock);
+        pr::saveState(m_shared->model, os);
+        os << ' ' << m_shared->real << ' ' << m_shared->estimated;
+      }
+
+      void loadState(std::istream& is) {
+        pr::loadState(m_evaluator, is);
+        std::lock_guard<std::mutex> lock(m_shared->lock);
+        pr::loadState(m_shared->model, is);
+        is >> std::ws >> m_shared->real >> std::ws >> m_shared->estimated;
+      }
+
+    private:
+      struct Shared {
+        explicit Shared(MType m) : model(std::move(m)) {}
+
+        MType model;
+        size_t real = 0;
+        size_t estimated = 0;
+        std::mutex lock;
+      };
+
+      template <typename FType>
+      void screen(Population& pop, std::vector<size_t> indices,
+          FType evaluate) {
+        if (indices.empty()) {
+          return;
+        }
+
+        std::vector<double> predicted(indices.size());
+        size_t keep = indices.size();
+        {
+          std::lock_guard<std::mutex> lock(m_shared->lock);
+          const MType& model = m_shared->model;
+
+          if (model.ready()) {
+            #pragma omp parallel for
+            for (long k = 0; k < static_cast<long>(indices.size()); k++) {
+              predicted[k] = model.predict(pr::progeny(pop[indices[k]]));
+            }
+
+            keep = std::min(indices.size(), std::max<size_t>(1,
+              static_cast<size_t>(std::ceil(m_fraction * indices.size()))));
+          }
+        }
+
+        // The most promising members go first, in index order.
+        std::vector<size_t> order(indices.size());
+        std::iota(order.begin(), order.end(), 0);
+        if (keep < indices.size()) {
+          std::nth_element(order.begin(), order.begin() + keep, order.end(),
+            [&predicted](size_t a, size_t b) {
+              return predicted[a] < predicted[b];
+            });
+          std::sort(order.begin(), order.begin() + keep);
+        }
+
+        for (size_t k = keep; k < order.size(); k++) {
+          CType& cnd = pop[indices[order[k]]];
+          pr::fitness(cnd) = static_cast<FitnessType>(predicted[order[k]]);
+          cnd.estimated = true;
+          cnd.valid = false;
+          cnd.changes.invalidate();
+        }
+
+        Population batch;
+        batch.reserve(keep);
+        for (size_t k = 0; k < keep; k++) {
+          batch.push_back(std::move(pop[indices[order[k]]]));
+        }
+
+        evaluate(batch);
+
+        std::lock_guard<std::mutex> lock(m_shared->lock);
+        for (size_t k = 0; k < keep; k++) {
+          CType& cnd = pop[indices[order[k]]];
+          cnd = std::move(batch[k]);
+          cnd.estimated = false;
+          cnd.valid = true;
+          m_shared->model.update(pr::progeny(cnd),
+            static_cast<double>(pr::fitness(cnd)));
+        }
+        m_shared->real += keep;
+        m_shared->estimated += indices.size() - keep;
+      }
+
+    private:
+      EType m_evaluator;
+      std::shared_ptr<Shared> m_shared;
+      double m_fraction;
+  };
+}
+
+#endif
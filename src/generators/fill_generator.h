@@ -5,9 +5,18 @@
 #include <algorithm>
 
 #include "../core/generator.h"
+#include "../core/random.h"
 
 namespace pr {
 
+  //! Generator that fills dead members from an initializer function.
+  /*!
+  *  The initializer either takes no arguments or takes a RandomStream. 
+  *  The latter is preferred: every member is drawn from the stream of its
+  *  own index, so the population is the same for any number of threads,
+  *  whereas an argument-less initializer sharing one engine is called 
+  *  concurrently and has to synchronize itself.
+  */
   template <typename CType>
   class FillGenerator : public Generator<CType> {
 
@@ -16,27 +25,74 @@ namespace pr {
       using typename Generator<CType>::Candidate;
       using typename Generator<CType>::Population;
       using Initializer = std::function<typename CType::BaseType(void)>;
+      using StreamInitializer = 
+        std::function<typename CType::BaseType(RandomStream&)>;
 
     public:
       FillGenerator(Initializer i) : Generator<CType>(),
         m_initializer(std::move(i)) {}
 
-      void generate(Population& pop) {
-        using FitnessType = typename Candidate::FitnessType;
+      FillGenerator(StreamInitializer i) : Generator<CType>(),
+        m_stream_initializer(std::move(i)) {}
 
+      void generate(Population& pop) {
         #pragma omp parallel for
         for (size_t i = 0; i < pop.size(); i++) {
-          if (!pop[i].alive) {
-            pr::progeny(pop[i]) = m_initializer();
-            pr::fitness(pop[i]) = FitnessType{};
-            pop[i].alive = true;
-          }
+          fill(pop, i);
+        }
+
+        m_random.next();
+      }
+
+      //! Generates a range without moving to new streams until the range
+      //! reaches the end of the population, so that a population filled
+      //! chunk by chunk matches one filled by generate().
+      void generateRange(Population& pop, size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) {
+          fill(pop, i);
+        }
+
+        if (last == pop.size()) {
+          m_random.next();
+        }
+      }
+
+      void seed(const Random& random) {
+        m_random = random;
+      }
+
+      void saveState(std::ostream& os) const {
+        m_random.saveState(os);
+      }
+
+      void loadState(std::istream& is) {
+        m_random.loadState(is);
+      }
+
+    private:
+      void fill(Population& pop, size_t i) {
+        using FitnessType = typename Candidate::FitnessType;
+
+        if (pop[i].alive) {
+          return;
         }
 
+        if (m_stream_initializer) {
+          RandomStream stream = m_random.stream(i);
+          pr::progeny(pop[i]) = m_stream_initializer(stream);
+        } else {
+          pr::progeny(pop[i]) = m_initializer();
+        }
+        pr::fitness(pop[i]) = FitnessType{};
+        pop[i].alive = true;
+        pop[i].valid = false;
+        pop[i].changes.invalidate();
       }
 
     private:
       Initializer m_initializer;
+      StreamInitializer m_stream_initializer;
+      Random m_random;
   };
 }
 #endif
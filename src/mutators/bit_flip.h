@@ -0,0 +1,134 @@
+#ifndef BIT_FLIP_H
+#define BIT_FLIP_H
+
+#include <cmath>
+#include <algorithm>
+#include <random>
+#include <istream>
+#include <ostream>
+
+#include "../core/mutator.h"
+#include "../core/random.h"
+#include "../core/bit_string.h"
+
+namespace pr {
+
+  //! Bit-flip mutation for BitString candidates.
+  /*!
+  *  Every bit of a living candidate flips independently with the given
+  *  rate, 1/N being the classic choice. Dense rates XOR each word with a
+  *  random mask whose bits are set with probability rate: starting from
+  *  an empty mask, the binary digits of the rate are consumed from the
+  *  least significant one, OR-ing a random word in for a one and AND-ing
+  *  one in for a zero. With 16 digits of precision that costs at most 16
+  *  random words per 64 genes. Sparse rates, below 1/16, instead jump
+  *  from one flipped bit to the next with geometric gaps.
+  *
+  *  BitFlip is element-wise, so it fuses with neighbouring element-wise
+  *  stages of a Pipeline.
+  */
+  template <typename CType>
+  class BitFlip : public Mutator<CType> {
+
+    static_assert(is_bit_string<typename CType::BaseType>::value,
+        "BitFlip requires a BitString progeny.");
+
+    public:
+      using Candidate = typename Mutator<CType>::Candidate;
+      using Population = typename Mutator<CType>::Population;
+
+    public:
+      //! \param rate Probability that each bit flips.
+      BitFlip(double rate) : Mutator<CType>(), m_rate(rate),
+        m_digits(static_cast<uint32_t>(std::lround(
+          std::min(std::max(rate, 0.0), 1.0) * (1 << Precision)))),
+        m_gap(std::min(std::max(rate, 1e-12), 1.0)) {}
+
+      void mutate(Population& pop) {
+        mutateRange(pop, 0, pop.size());
+      }
+
+      void mutateRange(Population& pop, size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) {
+          if (pop[i].alive) {
+            apply(pop[i]);
+          }
+        }
+      }
+
+      void apply(Candidate& cnd) {
+        if (m_rate <= 0.0) {
+          return;
+        }
+
+        BType& bits = pr::progeny(cnd);
+        if (m_rate < 1.0 / 16) {
+          sparse(bits);
+        } else {
+          dense(bits);
+        }
+        cnd.valid = false;
+        cnd.changes.invalidate();
+      }
+
+      void seed(const Random& random) {
+        m_stream = random.stream(0);
+      }
+
+      void saveState(std::ostream& os) const {
+        os << m_stream;
+      }
+
+      void loadState(std::istream& is) {
+        is >> m_stream;
+      }
+
+    private:
+      using BType = typename CType::BaseType;
+      using Word = typename BType::Word;
+      static const int Precision = 16;
+
+      Word word() {
+        return static_cast<Word>(m_stream()) << 32 | m_stream();
+      }
+
+      void dense(BType& bits) {
+        Word* words = bits.words();
+        for (size_t w = 0; w < BType::Words; w++) {
+          words[w] ^= mask();
+        }
+        bits.trim();
+      }
+
+      //! A word whose bits are set with probability m_digits / 2^16.
+      Word mask() {
+        if (m_digits >> Precision) {
+          return ~Word(0);
+        }
+
+        Word m = 0;
+        for (int d = __builtin_ctz(m_digits); d < Precision; d++) {
+          m = (m_digits >> d) & 1 ? m | word() : m & word();
+        }
+        return m;
+      }
+
+      void sparse(BType& bits) {
+        for (size_t i = m_gap(m_stream); i < BType::size();
+            i += m_gap(m_stream) + 1) {
+          bits.flip(i);
+        }
+      }
+
+    private:
+      double m_rate;
+      // The rate in units of 2^-16; 1 << 16 means every bit.
+      uint32_t m_digits;
+      std::geometric_distribution<size_t> m_gap;
+      // apply() sees one candidate at a time without its index, so BitFlip
+      // draws from a single stream like Point.
+      RandomStream m_stream;
+  };
+}
+
+#endif
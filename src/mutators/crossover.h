@@ -11,6 +11,8 @@
 #include <bitset>
 
 #include "../core/mutator.h"
+#include "../core/random.h"
+#include "../core/bit_string.h"
 #include "../core/type_traits.h"
 
 namespace pr {
@@ -38,14 +40,48 @@ namespace pr {
       Crossover(int points) : Mutator<CType>(), m_points(points) {};
 
       void mutate(Population& pop) {
+        cross(pop, 0, pop.size(), true);
+      }
 
-        typename std::vector<Candidate>::iterator ita = 
-          std::partition(pop.begin(), pop.end(), [](const Candidate& can) {
+      //! Serial, as Split already runs its branches concurrently.
+      void mutateRange(Population& pop, size_t first, size_t last) {
+        cross(pop, first, last, false);
+      }
+
+      void seed(const Random& random) {
+        m_random = random;
+      }
+
+      void saveState(std::ostream& os) const {
+        m_random.saveState(os);
+      }
+
+      void loadState(std::istream& is) {
+        m_random.loadState(is);
+      }
+
+    private:
+      using param_type = std::uniform_int_distribution<>::param_type;
+      using BType = typename Candidate::BaseType;
+
+      //! Crosses the living pairs in [first, last).
+      void cross(Population& pop, size_t first, size_t last, bool parallel) {
+
+        size_t alive = std::partition(pop.begin() + first, pop.begin() + last,
+          [](const Candidate& can) {
             return !can.alive;
-          });
+          }) - pop.begin();
 
-        auto itb = ita + 1;
-        for (; itb != pop.end() && ita != pop.end(); ita += 2, itb += 2) {
+        // Every pair draws from the stream of its first member, so pairs
+        // are independent and can be crossed in any order.
+        long pairs = (last - alive) / 2;
+
+        #pragma omp parallel for if (parallel)
+        for (long p = 0; p < pairs; p++) {
+          auto ita = pop.begin() + alive + 2 * p;
+          auto itb = ita + 1;
+          RandomStream stream = m_random.stream(alive + 2 * p);
+          std::uniform_int_distribution<int> distribution;
 
           BType a = pr::progeny(*ita);
           BType n_a;
@@ -59,14 +95,14 @@ namespace pr {
           // Generate and sort a list of crossover points for a.
           std::vector<int> a_points(m_points);
           std::generate_n(a_points.begin(), m_points, [&]() {
-            return m_distribution(m_generator, a_params);
+            return distribution(stream, a_params);
           });
           std::sort(std::begin(a_points), std::end(a_points));
 
           // Generate and sort a list of crossover points for b.
           std::vector<int> b_points(m_points);
           std::generate_n(b_points.begin(), m_points, [&]() {
-            return m_distribution(m_generator, b_params);
+            return distribution(stream, b_params);
           });
           std::sort(std::begin(b_points), std::end(b_points));
 
@@ -96,17 +132,18 @@ namespace pr {
 
           pr::progeny(*ita) = n_a;
           pr::progeny(*itb) = n_b;
+          ita->valid = false;
+          itb->valid = false;
+          ita->changes.invalidate();
+          itb->changes.invalidate();
         }
-      }
 
-    private:
-      using param_type = std::uniform_int_distribution<>::param_type;
-      using BType = typename Candidate::BaseType;
+        m_random.next();
+      }
 
     private:
       const int m_points;
-      std::default_random_engine m_generator;
-      std::uniform_int_distribution<int> m_distribution;
+      Random m_random;
   };
 
   //! Specialization for statically sized containers.
@@ -126,39 +163,196 @@ namespace pr {
       Crossover(int points) : Mutator<CType>(), m_points(points) {};
 
       void mutate(Population& pop) {
+        mutateRange(pop, 0, pop.size());
+      }
+
+      void mutateRange(Population& pop, size_t first, size_t last) {
 
-        std::random_device rd;
-        std::default_random_engine gen(rd());
+        RandomStream gen = m_random.stream(0);
+        m_random.next();
         std::uniform_int_distribution<int> dist{1, Size - 1};
         m_mask.reset();
 
         // TODO: Unroll on N as it is known at compile time.
-        // TODO: Use specified instead of default once wrapper is created.
         auto chunk = Mask{};
         for (int i = 0; i < m_points; i++) {
           chunk.set();
           m_mask ^= (chunk >> dist(gen)); 
         }
 
+        auto end = pop.begin() + last;
         typename std::vector<Candidate>::iterator ita = 
-          std::partition(pop.begin(), pop.end(), [](const Candidate& can) {
+          std::partition(pop.begin() + first, end, [](const Candidate& can) {
             return !can.alive;
           });
         auto itb = ita + 1;
 
-        for (; ita != pop.end() && itb != pop.end(); ita += 2, itb += 2) {
+        for (; ita != end && itb != end; ita += 2, itb += 2) {
+          record(*ita, *itb, is_std_array<typename CType::BaseType>());
           Cross<Size-1>::cross(*ita, *itb, m_mask);
+          ita->valid = false;
+          itb->valid = false;
         }
       }
 
+      void seed(const Random& random) {
+        m_random = random;
+      }
+
+      void saveState(std::ostream& os) const {
+        m_random.saveState(os);
+      }
+
+      void loadState(std::istream& is) {
+        m_random.loadState(is);
+      }
+
     protected: 
       static const size_t Size = std::tuple_size<typename CType::BaseType>::value;
       using Mask = std::bitset<Size>;
 
+      //! Lists the genes about to be swapped in both change sets, unless
+      //! they are too many to list.
+      void record(Candidate& a, Candidate& b, std::true_type) {
+        if (m_mask.count() > ChangeSet<typename CType::BaseType>::Capacity) {
+          record(a, b, std::false_type());
+          return;
+        }
+        for (size_t i = 0; i < Size; i++) {
+          if (m_mask[i]) {
+            pr::recordChange(a, i);
+            pr::recordChange(b, i);
+          }
+        }
+      }
+
+      void record(Candidate& a, Candidate& b, std::false_type) {
+        a.changes.invalidate();
+        b.changes.invalidate();
+      }
+
     protected:
       const int m_points;
       Mask m_mask;
+      Random m_random;
+
+  };
+
+  //! Specialization for packed bit strings.
+  /*!
+  *  Like the statically sized version, the genes to swap are marked by a
+  *  mask that is the XOR of one suffix mask per crossover point, but here
+  *  every pair draws its own points and the mask is built and applied a
+  *  word at a time: with d = (a ^ b) & mask, a ^= d and b ^= d exchange
+  *  the masked bits of 64 genes per step.
+  */
+  template <typename CType>
+  class Crossover<
+    CType,
+    typename std::enable_if<
+      is_bit_string<typename CType::BaseType>::value
+    >::type
+  > : public Mutator<CType> {
+
+    public:
+      using Candidate = typename Mutator<CType>::Candidate;
+      using Population = typename Mutator<CType>::Population;
+
+    public:
+      Crossover(int points) : Mutator<CType>(), m_points(points) {};
+
+      void mutate(Population& pop) {
+        cross(pop, 0, pop.size(), true);
+      }
+
+      //! Serial, as Split already runs its branches concurrently.
+      void mutateRange(Population& pop, size_t first, size_t last) {
+        cross(pop, first, last, false);
+      }
+
+      void seed(const Random& random) {
+        m_random = random;
+      }
+
+      void saveState(std::ostream& os) const {
+        m_random.saveState(os);
+      }
+
+      void loadState(std::istream& is) {
+        m_random.loadState(is);
+      }
+
+    private:
+      using BType = typename Candidate::BaseType;
+      using Word = typename BType::Word;
+      static const size_t Size = BType::size();
+      static const size_t Words = BType::Words;
+      static const size_t WordBits = BType::WordBits;
 
+      //! Crosses the living pairs in [first, last).
+      void cross(Population& pop, size_t first, size_t last, bool parallel) {
+
+        size_t alive = std::partition(pop.begin() + first, pop.begin() + last,
+          [](const Candidate& can) {
+            return !can.alive;
+          }) - pop.begin();
+
+        long pairs = Size > 1 ? (last - alive) / 2 : 0;
+
+        #pragma omp parallel for if (parallel)
+        for (long p = 0; p < pairs; p++) {
+          Candidate& a = pop[alive + 2 * p];
+          Candidate& b = pop[alive + 2 * p + 1];
+          RandomStream stream = m_random.stream(alive + 2 * p);
+
+          Word mask[Words];
+          makeMask(stream, mask);
+
+          Word* wa = pr::progeny(a).words();
+          Word* wb = pr::progeny(b).words();
+          for (size_t w = 0; w < Words; w++) {
+            Word d = (wa[w] ^ wb[w]) & mask[w];
+            wa[w] ^= d;
+            wb[w] ^= d;
+          }
+          a.valid = false;
+          b.valid = false;
+          a.changes.invalidate();
+          b.changes.invalidate();
+        }
+
+        m_random.next();
+      }
+
+      //! Marks the bits to swap: every point flips all bits from it on.
+      void makeMask(RandomStream& stream, Word* mask) const {
+        std::uniform_int_distribution<size_t> dist{1, Size - 1};
+
+        // A point inside word w flips its upper part there and toggles
+        // every later word, which a running parity applies in one pass.
+        bool toggles[Words + 1] = {};
+        for (size_t w = 0; w < Words; w++) {
+          mask[w] = 0;
+        }
+        for (int i = 0; i < m_points; i++) {
+          size_t point = dist(stream);
+          mask[point / WordBits] ^= ~((Word(1) << (point % WordBits)) - 1);
+          toggles[point / WordBits + 1] ^= true;
+        }
+
+        bool parity = false;
+        for (size_t w = 0; w < Words; w++) {
+          parity ^= toggles[w];
+          if (parity) {
+            mask[w] = ~mask[w];
+          }
+        }
+        mask[Words - 1] &= BType::lastMask();
+      }
+
+    private:
+      const int m_points;
+      Random m_random;
   };
 
   template <size_t X> 
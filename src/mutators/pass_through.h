@@ -21,6 +21,8 @@ namespace pr {
       PassThrough() : Mutator<CType>() {};
 
       void mutate(Population& pop) {}
+
+      void mutateRange(Population&, size_t, size_t) {}
   };
 }
 
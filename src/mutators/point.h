@@ -1,49 +1,108 @@
 #ifndef POINT_H
 #define POINT_H
 
+#include <vector>
+#include <random>
+#include <istream>
+#include <ostream>
+
 #include "../core/mutator.h"
+#include "../core/random.h"
 #include "../core/type_traits.h"
 
 namespace pr {
 
   //! Point mutation operator.
   /*!
-   * This mutator modifies a single point in the candidate based on a 
+   * This mutator modifies a single point in the candidate based on a
    * defined set, its associated probabilities and a binary selection
    * probability.
    */
   template <typename CType, class Enable = void>
   class Point;
 
-  //! Point mutation operator overloaded for statically sized containers.
+  //! Point mutation operator for homogeneous containers.
+  /*!
+  *  Covers both statically sized containers such as std::array and
+  *  dynamically sized ones such as std::string. Each living candidate is
+  *  picked with the selection probability; a picked candidate has one
+  *  uniformly chosen position replaced by a value drawn from the set.
+  *
+  *  Point is element-wise, so it fuses with neighbouring element-wise
+  *  stages of a Pipeline.
+  */
   template <typename CType>
   class Point<
     CType,
-    typename std::enable_if<is_static_container<CType>::value>::type
+    typename std::enable_if<
+      has_value_type<typename CType::BaseType>::value
+    >::type
   > : public Mutator<CType> {
 
     public:
       using Candidate = typename Mutator<CType>::Candidate;
       using Population = typename Mutator<CType>::Population;
+      using ValueType = typename CType::BaseType::value_type;
 
     public:
-      Point(){}
+      /*!
+      *  \param values The set of values a point may take.
+      *  \param weights Relative probability of each value.
+      *  \param probability Probability that a candidate is mutated.
+      */
+      Point(std::vector<ValueType> values, std::vector<double> weights,
+          double probability) :
+        Mutator<CType>(), m_values(values),
+        m_value(weights.begin(), weights.end()), m_select(probability) {}
 
-  };
+      //! Draws replacement values uniformly from \p values.
+      Point(std::vector<ValueType> values, double probability) :
+        Point(values, std::vector<double>(values.size(), 1.0), probability) {}
 
-  //! Point mutation operator overloaded for dynamically sized containers.
-  template <typename CType>
-  class Point<
-    CType,
-    typename std::enable_if<
-      !is_static_container<typename CType::BaseType>::value &&
-      has_value_type<typename CType::BaseType>::value
-    >::type
-  > : public Mutator<CType> {
+      void mutate(Population& pop) {
+        mutateRange(pop, 0, pop.size());
+      }
 
-    public:
-      Point(){}
+      void mutateRange(Population& pop, size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) {
+          if (pop[i].alive) {
+            apply(pop[i]);
+          }
+        }
+      }
+
+      void apply(Candidate& cnd) {
+        auto& progeny = pr::progeny(cnd);
+        if (progeny.size() == 0 || !m_select(m_stream)) {
+          return;
+        }
+
+        std::uniform_int_distribution<size_t> position(0, progeny.size() - 1);
+        size_t at = position(m_stream);
+        pr::recordChange(cnd, at);
+        progeny[at] = m_values[m_value(m_stream)];
+        cnd.valid = false;
+      }
+
+      void seed(const Random& random) {
+        m_stream = random.stream(0);
+      }
+
+      void saveState(std::ostream& os) const {
+        os << m_stream;
+      }
+
+      void loadState(std::istream& is) {
+        is >> m_stream;
+      }
 
+    private:
+      std::vector<ValueType> m_values;
+      std::discrete_distribution<size_t> m_value;
+      std::bernoulli_distribution m_select;
+      // apply() sees one candidate at a time without its index, so Point
+      // draws from a single stream and its loops stay serial.
+      RandomStream m_stream;
   };
 
 }
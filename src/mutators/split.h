@@ -1,32 +1,216 @@
 #ifndef SPLIT_H
 #define SPLIT_H
 
+#include <array>
+#include <tuple>
+#include <cmath>
+#include <functional>
+#include <algorithm>
+#include <omp.h>
+
 #include "../core/mutator.h"
 #include "../core/type_traits.h"
 
-template <unsigned int X>
-struct Split;
+namespace pr {
+
+  template <size_t X>
+  struct Branch;
+
+  //! Runs different mutators on disjoint slices of the population.
+  /*!
+  *  The living members of the population are gathered at the front of the
+  *  range and divided into one contiguous slice per branch, either by
+  *  ratio or by a classifier. Every branch then mutates its own slice in
+  *  place through mutateRange(), as an OpenMP task, so the branches run
+  *  concurrently and nothing is copied. Dead members are left for the
+  *  generator to refill.
+  *
+  *  Each branch owns its mutator, so stateful mutators such as Crossover
+  *  need no locking; their own parallel loops run serially inside the task.
+  *  \tparam CType The candidate type.
+  *  \tparam MTypes The mutator of each branch.
+  */
+  template <typename CType, typename... MTypes>
+  class Split : public Mutator<CType> {
+
+    static_assert(sizeof...(MTypes) > 0, "Split needs at least one branch.");
+
+    public:
+      using Candidate = typename Mutator<CType>::Candidate;
+      using Population = typename Mutator<CType>::Population;
+
+      static const size_t Arity = sizeof...(MTypes);
+      using Ratios = std::array<double, Arity>;
+      using Bounds = std::array<size_t, Arity + 1>;
+
+      //! Maps a candidate to the index of its branch. Indices past the
+      //! last branch go to the last branch.
+      using Classifier = std::function<size_t(const Candidate&)>;
+
+    public:
+      /*!
+      *  \param ratios Relative share of the living members per branch.
+      *  \param mutators The mutator of each branch.
+      */
+      Split(Ratios ratios, MTypes... mutators) :
+        Mutator<CType>(), m_ratios(ratios), m_mutators(mutators...) {}
+
+      /*!
+      *  \param classify Picks the branch of each living member.
+      *  \param mutators The mutator of each branch.
+      */
+      Split(Classifier classify, MTypes... mutators) :
+        Mutator<CType>(), m_ratios(), m_classify(classify), 
+        m_mutators(mutators...) {}
+
+      void mutate(Population& pop) {
+        mutateRange(pop, 0, pop.size());
+      }
+
+      void mutateRange(Population& pop, size_t first, size_t last) {
+        Bounds bounds = partition(pop, first, last);
+
+        #pragma omp parallel
+        {
+          #pragma omp single
+          Branch<Arity - 1>::spawn(m_mutators, pop, bounds);
+        }
+      }
+
+      void seed(const Random& random) {
+        Branch<Arity - 1>::seed(m_mutators, random);
+      }
+
+      void saveState(std::ostream& os) const {
+        Branch<Arity - 1>::save(m_mutators, os);
+      }
+
+      void loadState(std::istream& is) {
+        Branch<Arity - 1>::load(m_mutators, is);
+      }
+
+    private:
+      //! Reorders [first, last) into the branch slices.
+      Bounds partition(Population& pop, size_t first, size_t last) {
+        auto begin = pop.begin() + first;
+        size_t alive = std::partition(begin, pop.begin() + last,
+          [](const Candidate& cnd) { return cnd.alive; }) - begin;
+
+        Bounds bounds;
+        bounds[0] = first;
+        bounds[Arity] = first + alive;
+
+        if (m_classify) {
+          for (size_t k = 0; k + 1 < Arity; k++) {
+            bounds[k + 1] = std::partition(
+              pop.begin() + bounds[k], pop.begin() + bounds[Arity],
+              [this, k](const Candidate& cnd) {
+                return m_classify(cnd) == k;
+              }) - pop.begin();
+          }
+          return bounds;
+        }
 
-template <typename Progeny, class Enable = void>
-class Split;
+        double total = 0.0;
+        for (double r : m_ratios) {
+          total += r;
+        }
 
-template <typename Progeny>
-class Split<
-  Progeny, 
-  typename std::enable_if<is_static_container<Progeny>::value>::type
-> : public Mutator<Progeny, Split<Progeny>> {
+        double share = 0.0;
+        for (size_t k = 0; k + 1 < Arity; k++) {
+          share += m_ratios[k];
+          bounds[k + 1] = first +
+            static_cast<size_t>(std::round(alive * share / total));
+        }
+        return bounds;
+      }
 
-  using Population = std::vector<Progeny>;
+    private:
+      Ratios m_ratios;
+      Classifier m_classify;
+      std::tuple<MTypes...> m_mutators;
+  };
 
-  public:
-    static const size_t Arity;
+  //! Recursion over the branches of a Split.
+  template <size_t X>
+  struct Branch {
 
-  public:
-    Split(Mutator<Progeny>... mutators) : Mutator<Progeny, Split<N, Progeny>>(), 
-      Arity(sizeof...(mutators)) {};
+    template <typename Tuple, typename Pop, typename Bounds>
+    static void spawn(Tuple& mutators, Pop& pop, const Bounds& bounds) {
+      Branch<X - 1>::spawn(mutators, pop, bounds);
 
-    Population mutate(Population&& pop) {
+      auto* mutator = &std::get<X>(mutators);
+      Pop* target = &pop;
+      size_t first = bounds[X];
+      size_t last = bounds[X + 1];
+
+      #pragma omp task firstprivate(mutator, target, first, last)
+      mutator->mutateRange(*target, first, last);
+    }
+
+    template <typename Tuple>
+    static void seed(Tuple& mutators, const Random& random) {
+      Branch<X - 1>::seed(mutators, random);
+      pr::seed(std::get<X>(mutators), random.fork(X));
+    }
+
+    template <typename Tuple>
+    static void save(const Tuple& mutators, std::ostream& os) {
+      Branch<X - 1>::save(mutators, os);
+      os << ' ';
+      pr::saveState(std::get<X>(mutators), os);
+    }
+
+    template <typename Tuple>
+    static void load(Tuple& mutators, std::istream& is) {
+      Branch<X - 1>::load(mutators, is);
+      pr::loadState(std::get<X>(mutators), is);
+    }
+  };
+
+  template <>
+  struct Branch<0> {
+
+    template <typename Tuple, typename Pop, typename Bounds>
+    static void spawn(Tuple& mutators, Pop& pop, const Bounds& bounds) {
+      auto* mutator = &std::get<0>(mutators);
+      Pop* target = &pop;
+      size_t first = bounds[0];
+      size_t last = bounds[1];
+
+      #pragma omp task firstprivate(mutator, target, first, last)
+      mutator->mutateRange(*target, first, last);
     }
-};
+
+    template <typename Tuple>
+    static void seed(Tuple& mutators, const Random& random) {
+      pr::seed(std::get<0>(mutators), random.fork(0));
+    }
+
+    template <typename Tuple>
+    static void save(const Tuple& mutators, std::ostream& os) {
+      pr::saveState(std::get<0>(mutators), os);
+    }
+
+    template <typename Tuple>
+    static void load(Tuple& mutators, std::istream& is) {
+      pr::loadState(std::get<0>(mutators), is);
+    }
+  };
+
+  //! Builds a Split that divides the living members by \p ratios.
+  /*!
+  *  For example, `split({0.7, 0.2, 0.1}, cross, point, pass)` sends 70%
+  *  of the survivors through crossover, 20% through point mutation and
+  *  leaves the rest as they are.
+  */
+  template <typename MType, typename... MTypes>
+  Split<typename MType::Candidate, MType, MTypes...> split(
+      std::array<double, 1 + sizeof...(MTypes)> ratios,
+      MType mutator, MTypes... mutators) {
+    return Split<typename MType::Candidate, MType, MTypes...>(
+      ratios, mutator, mutators...);
+  }
+}
 
 #endif
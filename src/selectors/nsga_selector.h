@@ -0,0 +1,273 @@
+#ifndef NSGA_SELECTOR_H
+#define NSGA_SELECTOR_H
+
+#include <vector>
+#include <limits>
+#include <numeric>
+#include <algorithm>
+#include <functional>
+#include <omp.h>
+
+#include "../core/selector.h"
+#include "../core/objectives.h"
+
+namespace pr {
+
+  //! Sorts [first, last) with one std::sort per thread followed by rounds
+  //! of pairwise merges, for the large index arrays of the selectors.
+  template <typename It, typename Compare>
+  void parallelSort(It first, It last, Compare less) {
+    long n = last - first;
+    long chunks = std::min<long>(omp_get_max_threads(), n / 4096 + 1);
+
+    std::vector<long> bounds(chunks + 1);
+    for (long c = 0; c <= chunks; c++) {
+      bounds[c] = n * c / chunks;
+    }
+
+    #pragma omp parallel for schedule(static, 1)
+    for (long c = 0; c < chunks; c++) {
+      std::sort(first + bounds[c], first + bounds[c + 1], less);
+    }
+
+    for (long width = 1; width < chunks; width *= 2) {
+      #pragma omp parallel for schedule(static, 1)
+      for (long c = 0; c < chunks - width; c += 2 * width) {
+        long end = std::min(c + 2 * width, chunks);
+        std::inplace_merge(first + bounds[c], first + bounds[c + width],
+          first + bounds[end], less);
+      }
+    }
+  }
+
+  //! Assigns every point its Pareto front, 0 being the non-dominated one.
+  /*!
+  *  Implements the efficient non-dominated sort with binary search
+  *  (ENS-BS, Zhang et al. 2015). Points are visited in lexicographic
+  *  order, so a point can only be dominated by points already placed, and
+  *  the fronts are probed by binary search: if a point is dominated by
+  *  some member of front k, it is dominated by some member of every
+  *  earlier front as well.
+  *
+  *  With two objectives the members of a front, in visiting order, have
+  *  a falling second objective, so only the last member of a front needs
+  *  checking and the whole sort costs O(N log N). With more objectives a
+  *  front is scanned from its newest member backwards, which is far below
+  *  the O(MN^2) of the classic fast non-dominated sort in practice.
+  *  \param keys Row-major N x M matrix of objectives, lower is better.
+  *  \param n Number of points.
+  *  \param m Number of objectives.
+  *  \return The front index of every point.
+  */
+  inline std::vector<size_t> nondominatedSort(const std::vector<double>& keys,
+      size_t n, size_t m) {
+    std::vector<size_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+
+    parallelSort(order.begin(), order.end(), [&](size_t a, size_t b) {
+      const double* ka = &keys[a * m];
+      const double* kb = &keys[b * m];
+      for (size_t j = 0; j < m; j++) {
+        if (ka[j] != kb[j]) {
+          return ka[j] < kb[j];
+        }
+      }
+      return a < b;
+    });
+
+    // Each front keeps the objectives of its members contiguously, in
+    // visiting order, so scanning it streams through memory.
+    std::vector<std::vector<double>> fronts;
+
+    // A member q of a front was visited before p, so it is
+    // lexicographically no greater and dominates p unless p is better in
+    // some later objective or equal throughout.
+    auto dominates = [m](const double* kq, const double* kp) {
+      bool better = kq[0] < kp[0];
+      for (size_t j = 1; j < m; j++) {
+        if (kp[j] < kq[j]) {
+          return false;
+        }
+        better = better || kq[j] < kp[j];
+      }
+      return better;
+    };
+
+    auto dominatedBy = [&](const std::vector<double>& front,
+        const double* kp) {
+      const double* first = front.data();
+      const double* kq = first + front.size() - m;
+      if (m == 2) {
+        return dominates(kq, kp);
+      }
+      for (; kq >= first; kq -= m) {
+        if (dominates(kq, kp)) {
+          return true;
+        }
+      }
+      return false;
+    };
+
+    std::vector<size_t> rank(n);
+    for (size_t p : order) {
+      const double* kp = &keys[p * m];
+      size_t low = 0;
+      size_t high = fronts.size();
+      while (low < high) {
+        size_t mid = (low + high) / 2;
+        if (dominatedBy(fronts[mid], kp)) {
+          low = mid + 1;
+        } else {
+          high = mid;
+        }
+      }
+
+      if (low == fronts.size()) {
+        fronts.emplace_back();
+      }
+      fronts[low].insert(fronts[low].end(), kp, kp + m);
+      rank[p] = low;
+    }
+    return rank;
+  }
+
+  //! Crowding distance of the points in \p front, in the same order.
+  /*!
+  *  The distance of a point is the sum over the objectives of the
+  *  normalized gap between its neighbours along that objective; the
+  *  extremes of every objective get an infinite distance. Each objective
+  *  is sorted with parallelSort() and the gaps are added in parallel.
+  */
+  inline std::vector<double> crowdingDistance(const std::vector<double>& keys,
+      size_t m, const std::vector<size_t>& front) {
+    long n = front.size();
+    std::vector<double> distance(n, 0.0);
+    if (n < 3) {
+      std::fill(distance.begin(), distance.end(),
+        std::numeric_limits<double>::infinity());
+      return distance;
+    }
+
+    // Positions into front, so the distances can be written in place.
+    std::vector<size_t> order(n);
+    for (size_t j = 0; j < m; j++) {
+      std::iota(order.begin(), order.end(), 0);
+      parallelSort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        double ka = keys[front[a] * m + j];
+        double kb = keys[front[b] * m + j];
+        return ka < kb || (ka == kb && a < b);
+      });
+
+      double low = keys[front[order.front()] * m + j];
+      double range = keys[front[order.back()] * m + j] - low;
+      distance[order.front()] = std::numeric_limits<double>::infinity();
+      distance[order.back()] = std::numeric_limits<double>::infinity();
+      if (range <= 0.0) {
+        continue;
+      }
+
+      #pragma omp parallel for schedule(static)
+      for (long i = 1; i < n - 1; i++) {
+        double gap = keys[front[order[i + 1]] * m + j] -
+          keys[front[order[i - 1]] * m + j];
+        distance[order[i]] += gap / range;
+      }
+    }
+    return distance;
+  }
+
+  //! Elitist multi-objective selection in the manner of NSGA-II.
+  /*!
+  *  Survivors are taken front by front in order of Pareto rank. The front
+  *  that does not fit entirely is truncated by crowding distance, keeping
+  *  the members in the least crowded regions so the survivors stay spread
+  *  along the front.
+  *  \tparam CType A candidate whose fitness is Objectives.
+  */
+  template <typename CType>
+  class NSGASelector : public Selector<CType> {
+
+    using Candidate = CType;
+    using Population = pr::Population<Candidate>;
+    using FitnessType = typename Candidate::FitnessType;
+
+    static_assert(is_objectives<FitnessType>::value,
+        "NSGASelector needs a candidate with Objectives fitness.");
+
+    static const size_t M = FitnessType::Count;
+
+    public:
+      /*!
+      *  \param natural If true, higher objectives are better; otherwise
+      *  they are errors, as in the rest of the library.
+      */
+      virtual void select(Population& pop, int count, bool natural = true) {
+        size_t n = pop.size();
+        m_keys.resize(n * M);
+
+        #pragma omp parallel for schedule(static)
+        for (long i = 0; i < static_cast<long>(n); i++) {
+          const auto& fit = pr::fitness(pop[i]);
+          for (size_t j = 0; j < M; j++) {
+            double v = static_cast<double>(fit[j]);
+            m_keys[i * M + j] = natural ? -v : v;
+          }
+          pop[i].alive = false;
+        }
+
+        m_ranks = nondominatedSort(m_keys, n, M);
+
+        size_t fronts = n ? *std::max_element(m_ranks.begin(),
+          m_ranks.end()) + 1 : 0;
+        std::vector<size_t> sizes(fronts, 0);
+        for (size_t r : m_ranks) {
+          sizes[r]++;
+        }
+
+        // Every front below the cut survives whole.
+        size_t wanted = std::min<size_t>(std::max(count, 0), n);
+        size_t cut = 0;
+        size_t taken = 0;
+        while (cut < fronts && taken + sizes[cut] <= wanted) {
+          taken += sizes[cut++];
+        }
+
+        std::vector<size_t> last;
+        for (size_t i = 0; i < n; i++) {
+          if (m_ranks[i] < cut) {
+            pop[i].alive = true;
+          } else if (m_ranks[i] == cut) {
+            last.push_back(i);
+          }
+        }
+
+        if (taken == wanted || last.empty()) {
+          return;
+        }
+
+        std::vector<double> distance = crowdingDistance(m_keys, M, last);
+        std::vector<size_t> order(last.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::nth_element(order.begin(), order.begin() + (wanted - taken),
+          order.end(), [&](size_t a, size_t b) {
+            return distance[a] > distance[b] ||
+              (distance[a] == distance[b] && a < b);
+          });
+
+        for (size_t i = 0; i < wanted - taken; i++) {
+          pop[last[order[i]]].alive = true;
+        }
+      }
+
+      //! Pareto rank of every member as of the last selection.
+      const std::vector<size_t>& ranks() const {
+        return m_ranks;
+      }
+
+    private:
+      std::vector<double> m_keys;
+      std::vector<size_t> m_ranks;
+  };
+
+} // ::pr
+#endif
@@ -2,10 +2,17 @@
 #define ROULETTE_SELECTOR_H
 
 #include <random>
+#include <vector>
+#include <algorithm>
+#include <numeric>
 #include <omp.h>
 #include <iostream>
+#include <istream>
+#include <ostream>
 
 #include "../core/selector.h"
+#include "../core/random.h"
+#include "../util/fenwick_tree.h"
 
 namespace pr {
 
@@ -19,8 +26,7 @@ class RouletteSelector : public Selector<CType> {
   public:
     virtual void select(Population& pop, int count, bool natural = true) {
 
-      std::default_random_engine gen;
-      std::vector<FitnessType> weights(pop.size());
+      m_weights.resize(pop.size());
 
       // If necessary, re-normalize population.
       if (!natural) {
@@ -37,27 +43,142 @@ class RouletteSelector : public Selector<CType> {
 
           #pragma omp for
           for (int i = 0; i < pop.size(); ++i) {
-            weights[i] = (max_fit + 1) - pr::fitness(pop[i]);
+            m_weights[i] = (max_fit + 1) - pr::fitness(pop[i]);
             pop[i].alive = false;
           }
         }
       } else {
         #pragma omp parallel for
         for (int i = 0; i < pop.size(); ++i) {
-          weights[i] = pr::fitness(pop[i]);
+          m_weights[i] = pr::fitness(pop[i]);
           pop[i].alive = false;
         }
       }
 
-      std::discrete_distribution<> dist(weights.begin(), weights.end());
+      // Sampling without replacement: every pick is a search of the sum
+      // tree, and removing it an update, both O(log N).
+      size_t n = pop.size();
+      size_t positive = 0;
+      #pragma omp parallel for reduction(+:positive)
+      for (long i = 0; i < static_cast<long>(n); ++i) {
+        m_weights[i] = std::max(m_weights[i], 0.0);
+        positive += m_weights[i] > 0;
+      }
+      m_tree.build(m_weights);
+
+      // Every pick needs one uniform value, so they are drawn in bulk up
+      // front; the stream serves the rare repeated draws.
+      size_t picks = std::min(static_cast<size_t>(std::max(count, 0)), n);
+      m_draws.resize(picks);
+      m_random.uniform(m_draws, Bulk);
+      RandomStream stream = m_random.stream(0);
+      m_random.next();
 
-      for (int i = 0; i < count; ++i){
-        int idx = dist(gen);
-        weights[idx] = 0.0;
-        dist.param({ weights.begin(), weights.end() });
+      size_t picked = 0;
+      for (; picked < picks && positive > 0; ++picked) {
+        size_t idx = draw(m_draws[picked], stream);
+        double weight = m_weights[idx];
+        double rest = m_tree.total() - weight;
+        m_weights[idx] = 0.0;
+
+        // Subtracting a weight that dwarfs all others would leave little
+        // but its rounding error in the tree, so the tree is rebuilt from
+        // the weights instead.
+        if (weight > Cancellation * rest) {
+          m_tree.build(m_weights);
+        } else {
+          m_tree.add(idx, -weight);
+        }
+        positive--;
         pop[idx].alive = true;
       }
+
+      // Members without weight are only picked once nobody else is left,
+      // uniformly among themselves.
+      if (picked < picks) {
+        std::vector<size_t> rest;
+        for (size_t i = 0; i < n; ++i) {
+          if (!pop[i].alive) {
+            rest.push_back(i);
+          }
+        }
+        for (size_t k = 0; picked < picks; ++k, ++picked) {
+          std::uniform_int_distribution<size_t> other(k, rest.size() - 1);
+          std::swap(rest[k], rest[other(stream)]);
+          pop[rest[k]].alive = true;
+        }
+      }
+    }
+
+    void seed(const Random& random) {
+      m_random = random;
+    }
+
+    void saveState(std::ostream& os) const {
+      m_random.saveState(os);
+    }
+
+    void loadState(std::istream& is) {
+      m_random.loadState(is);
+    }
+
+  private:
+    // Weight ratio beyond which removal rebuilds the tree.
+    static constexpr double Cancellation = 1e6;
+    // Draws before the tree is rebuilt, and before falling back on a scan.
+    static const int Attempts = 8;
+    // Stream id of the bulk draws, apart from the stream of repeats.
+    static const uint64_t Bulk = 1;
+
+    //! Draws a member with weight left, by weight, at \p u in [0, 1).
+    /*!
+    *  Removals leave rounding residues in the tree, and a draw landing on
+    *  one is repeated with a value from \p stream. Should that keep
+    *  happening, the tree is rebuilt from the weights, and as a last
+    *  resort the weights are scanned.
+    */
+    size_t draw(double u, RandomStream& stream) {
+      std::uniform_real_distribution<double> unit;
+      size_t n = m_weights.size();
+
+      for (int round = 0; round < 2; ++round) {
+        for (int attempt = 0; attempt < Attempts; ++attempt) {
+          double total = m_tree.total();
+          if (!(total > 0.0)) {
+            break;
+          }
+          size_t idx = m_tree.find(u * total);
+          if (idx < n && m_weights[idx] > 0.0) {
+            return idx;
+          }
+          u = unit(stream);
+        }
+        m_tree.build(m_weights);
+      }
+
+      double point = unit(stream) * 
+        std::accumulate(m_weights.begin(), m_weights.end(), 0.0);
+      size_t last = n;
+      for (size_t i = 0; i < n; ++i) {
+        if (m_weights[i] > 0.0) {
+          last = i;
+          if (point < m_weights[i]) {
+            break;
+          }
+          point -= m_weights[i];
+        }
+      }
+      return last;
     }
+
+  private:
+    // Reused from call to call.
+    std::vector<double> m_weights;
+    std::vector<double> m_draws;
+    FenwickTree<double> m_tree;
+    // Advanced on every call so that repeated selections over an unchanged 
+    // population do not draw the same members every time.
+    Random m_random;
 };
 
 
@@ -0,0 +1,86 @@
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+namespace pr {
+
+  //! Blocking FIFO with a fixed capacity.
+  /*!
+  *  Producers block while the queue is full, consumers block while it is
+  *  empty. Closing the queue wakes everybody up: pending items can still be
+  *  popped, after which pop() returns false.
+  *  \tparam T The item type.
+  */
+  template <typename T>
+  class BoundedQueue {
+
+    public:
+      BoundedQueue(size_t capacity) : m_capacity(capacity), m_closed(false) {}
+
+      BoundedQueue(const BoundedQueue&) = delete;
+      BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+      //! Enqueues an item, waiting for room if necessary.
+      /*!
+      *  \returns False if the queue was closed and the item dropped.
+      */
+      bool push(T item) {
+        std::unique_lock<std::mutex> lock(m_lock);
+        m_not_full.wait(lock, [this]{
+          return m_closed || m_items.size() < m_capacity;
+        });
+
+        if (m_closed) {
+          return false;
+        }
+
+        m_items.push_back(std::move(item));
+        lock.unlock();
+        m_not_empty.notify_one();
+        return true;
+      }
+
+      //! Dequeues an item, waiting for one if necessary.
+      /*!
+      *  \returns False once the queue is closed and drained.
+      */
+      bool pop(T& item) {
+        std::unique_lock<std::mutex> lock(m_lock);
+        m_not_empty.wait(lock, [this]{
+          return m_closed || !m_items.empty();
+        });
+
+        if (m_items.empty()) {
+          return false;
+        }
+
+        item = std::move(m_items.front());
+        m_items.pop_front();
+        lock.unlock();
+        m_not_full.notify_one();
+        return true;
+      }
+
+      void close() {
+        {
+          std::lock_guard<std::mutex> lock(m_lock);
+          m_closed = true;
+        }
+        m_not_empty.notify_all();
+        m_not_full.notify_all();
+      }
+
+    private:
+      const size_t m_capacity;
+      bool m_closed;
+      std::deque<T> m_items;
+      std::mutex m_lock;
+      std::condition_variable m_not_empty;
+      std::condition_variable m_not_full;
+  };
+}
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef CACHE_STATS_H
+#define CACHE_STATS_H
+
+#include <cstddef>
+
+namespace pr {
+
+  //! Counters of a ConcurrentMap, reported by caching evaluators.
+  struct CacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    size_t entries = 0;
+  };
+}
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef CANCELLATION_H
+#define CANCELLATION_H
+
+#include <atomic>
+#include <memory>
+
+namespace pr {
+
+  //! Shared flag used to ask a running simulation to stop.
+  /*!
+  *  Copies share the same flag, so a caller can keep one copy and hand
+  *  another to the run. Cancellation is cooperative: the run checks the
+  *  flag between pipeline stages and stops at the next check. A default
+  *  constructed token has no flag and is never cancelled.
+  */
+  class CancellationToken {
+
+    public:
+      CancellationToken() = default;
+
+      static CancellationToken create() {
+        CancellationToken token;
+        token.m_flag = std::make_shared<std::atomic<bool>>(false);
+        return token;
+      }
+
+      void cancel() {
+        if (m_flag) {
+          m_flag->store(true, std::memory_order_relaxed);
+        }
+      }
+
+      bool cancelled() const {
+        return m_flag && m_flag->load(std::memory_order_relaxed);
+      }
+
+    private:
+      std::shared_ptr<std::atomic<bool>> m_flag;
+  };
+}
+
+#endif
@@ -1,12 +1,182 @@
 #ifndef CONCURRENT_MAP_H
 #define CONCURRENT_MAP_H
 
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <functional>
+#include <unordered_map>
 #include <boost/thread.hpp>
 
+#include "cache_stats.h"
+
 namespace pr {
 
-  template <typename KType, typename VType>
-  class ConcurrentMap {};
+  //! Bounded hash map for concurrent lookups, evicting with CLOCK.
+  /*!
+  *  The keys are spread over independently locked shards, so threads
+  *  working on different keys rarely meet. Lookups take a shard's lock in
+  *  shared mode only: CLOCK records a use by setting an atomic reference
+  *  bit, where LRU would have to relink a list under an exclusive lock.
+  *
+  *  Each shard holds a fixed ring of slots. Once the ring is full, an
+  *  insertion sweeps the clock hand over it, clearing reference bits,
+  *  and replaces the first entry that was not used since the last sweep.
+  *  \tparam KType The key type.
+  *  \tparam VType The value type, returned by copy.
+  *  \tparam Hash Hash function object for keys.
+  */
+  template <typename KType, typename VType, typename Hash = std::hash<KType>>
+  class ConcurrentMap {
+
+    public:
+      /*!
+      *  \param capacity Maximum number of entries over all shards.
+      *  \param shards Number of independently locked shards, rounded up to
+      *  a power of two.
+      */
+      explicit ConcurrentMap(size_t capacity, size_t shards = 64,
+          Hash hash = Hash()) : m_hash(hash), m_mask(1) {
+        while (m_mask < shards) {
+          m_mask <<= 1;
+        }
+
+        size_t per_shard = (capacity + m_mask - 1) / m_mask;
+        m_shards.reset(new Shard[m_mask]);
+        for (size_t s = 0; s < m_mask; s++) {
+          m_shards[s].reset(per_shard ? per_shard : 1);
+        }
+        m_mask--;
+      }
+
+      ConcurrentMap(const ConcurrentMap&) = delete;
+      ConcurrentMap& operator=(const ConcurrentMap&) = delete;
+
+      //! Copies the value stored for \p key into \p value, if any.
+      bool find(const KType& key, VType& value) const {
+        Shard& shard = shardOf(key);
+        boost::shared_lock<boost::shared_mutex> lock(shard.mutex);
+
+        auto it = shard.index.find(key);
+        if (it == shard.index.end()) {
+          shard.misses.fetch_add(1, std::memory_order_relaxed);
+          return false;
+        }
+
+        Slot& slot = shard.slots[it->second];
+        slot.referenced.store(true, std::memory_order_relaxed);
+        value = slot.value;
+        shard.hits.fetch_add(1, std::memory_order_relaxed);
+        return true;
+      }
+
+      //! Stores \p value for \p key, evicting an entry if the shard is full.
+      void insert(const KType& key, const VType& value) {
+        Shard& shard = shardOf(key);
+        boost::unique_lock<boost::shared_mutex> lock(shard.mutex);
+
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) {
+          shard.slots[it->second].value = value;
+          return;
+        }
+
+        size_t s = shard.used < shard.slots.size() ?
+          shard.used++ : shard.victim();
+        Slot& slot = shard.slots[s];
+        if (slot.occupied) {
+          shard.index.erase(slot.key);
+          shard.evictions++;
+        }
+
+        slot.key = key;
+        slot.value = value;
+        slot.occupied = true;
+        slot.referenced.store(false, std::memory_order_relaxed);
+        shard.index.emplace(key, s);
+      }
+
+      //! Drops every entry; the counters are kept.
+      void clear() {
+        for (size_t s = 0; s <= m_mask; s++) {
+          Shard& shard = m_shards[s];
+          boost::unique_lock<boost::shared_mutex> lock(shard.mutex);
+          shard.reset(shard.slots.size());
+        }
+      }
+
+      CacheStats stats() const {
+        CacheStats total;
+        for (size_t s = 0; s <= m_mask; s++) {
+          Shard& shard = m_shards[s];
+          total.hits += shard.hits.load(std::memory_order_relaxed);
+          total.misses += shard.misses.load(std::memory_order_relaxed);
+
+          boost::shared_lock<boost::shared_mutex> lock(shard.mutex);
+          total.evictions += shard.evictions;
+          total.entries += shard.index.size();
+        }
+        return total;
+      }
+
+      size_t capacity() const {
+        return (m_mask + 1) * m_shards[0].slots.size();
+      }
+
+    private:
+      struct Slot {
+        KType key;
+        VType value;
+        bool occupied = false;
+        std::atomic<bool> referenced{false};
+      };
+
+      struct Shard {
+        void reset(size_t size) {
+          std::vector<Slot>(size).swap(slots);
+          index.clear();
+          used = 0;
+          hand = 0;
+        }
+
+        //! Advances the clock hand to the next entry not used recently.
+        size_t victim() {
+          while (slots[hand].referenced.exchange(false,
+              std::memory_order_relaxed)) {
+            hand = (hand + 1) % slots.size();
+          }
+          size_t s = hand;
+          hand = (hand + 1) % slots.size();
+          return s;
+        }
+
+        mutable boost::shared_mutex mutex;
+        std::vector<Slot> slots;
+        std::unordered_map<KType, size_t, Hash> index;
+        size_t used = 0;
+        size_t hand = 0;
+        size_t evictions = 0;
+        std::atomic<size_t> hits{0};
+        std::atomic<size_t> misses{0};
+        // Keeps the counters of neighbouring shards off one cache line.
+        char padding[64];
+      };
+
+    private:
+      Shard& shardOf(const KType& key) const {
+        // Mix the high bits in, the shard index should not reuse the bits
+        // the per-shard table picks its buckets from.
+        size_t h = m_hash(key);
+        h ^= h >> 29;
+        h *= 0x9E3779B97F4A7C15ull;
+        return m_shards[(h >> 32) & m_mask];
+      }
+
+    private:
+      Hash m_hash;
+      size_t m_mask;
+      std::unique_ptr<Shard[]> m_shards;
+  };
 }
 
 #endif
@@ -0,0 +1,90 @@
+#ifndef FENWICK_TREE_H
+#define FENWICK_TREE_H
+
+#include <vector>
+#include <cstddef>
+
+namespace pr {
+
+  //! Prefix sums over a changing array of non-negative weights.
+  /*!
+  *  Node i of the binary indexed tree holds the sum of the weights in
+  *  (i - lowbit(i), i], so a point update and the search for the element
+  *  at a given prefix sum both walk O(log N) nodes. Building from a whole
+  *  array is O(N). Sampling a weight with probability proportional to its
+  *  share of the total is a find() at a uniform point in [0, total()).
+  *  \tparam T The weight type.
+  */
+  template <typename T>
+  class FenwickTree {
+
+    public:
+      FenwickTree() = default;
+
+      explicit FenwickTree(const std::vector<T>& weights) {
+        build(weights);
+      }
+
+      //! Replaces the contents with \p weights in O(N).
+      void build(const std::vector<T>& weights) {
+        size_t n = weights.size();
+        m_tree.assign(n + 1, T());
+        for (size_t i = 1; i <= n; i++) {
+          m_tree[i] += weights[i - 1];
+          size_t parent = i + (i & (~i + 1));
+          if (parent <= n) {
+            m_tree[parent] += m_tree[i];
+          }
+        }
+
+        m_top = 1;
+        while (m_top * 2 <= n) {
+          m_top *= 2;
+        }
+      }
+
+      size_t size() const {
+        return m_tree.empty() ? 0 : m_tree.size() - 1;
+      }
+
+      //! Adds \p delta to weight \p i.
+      void add(size_t i, T delta) {
+        for (size_t j = i + 1; j < m_tree.size(); j += j & (~j + 1)) {
+          m_tree[j] += delta;
+        }
+      }
+
+      //! Sum of the weights before \p i.
+      T prefix(size_t i) const {
+        T sum = T();
+        for (size_t j = i; j > 0; j -= j & (~j + 1)) {
+          sum += m_tree[j];
+        }
+        return sum;
+      }
+
+      T total() const {
+        return prefix(size());
+      }
+
+      //! The first element whose prefix sum including itself exceeds
+      //! \p point, or size() if there is none. Zero weights are never
+      //! found.
+      size_t find(T point) const {
+        size_t pos = 0;
+        for (size_t step = m_top; step > 0; step /= 2) {
+          if (pos + step < m_tree.size() && !(point < m_tree[pos + step])) {
+            pos += step;
+            point -= m_tree[pos];
+          }
+        }
+        return pos;
+      }
+
+    private:
+      std::vector<T> m_tree;
+      size_t m_top = 0;
+  };
+}
+
+#endif
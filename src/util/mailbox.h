@@ -0,0 +1,92 @@
+#ifndef MAILBOX_H
+#define MAILBOX_H
+
+#include <atomic>
+#include <utility>
+
+namespace pr {
+
+  //! Lock-free multi-producer, single-consumer mailbox.
+  /*!
+  *  Producers push messages onto an intrusive stack with a single CAS. The
+  *  consumer detaches the whole stack with one exchange, so neither side
+  *  ever blocks and there is no ABA hazard: a node is never popped while
+  *  other nodes are still reachable by producers.
+  *  \tparam T The message type.
+  */
+  template <typename T>
+  class Mailbox {
+
+    struct Node {
+      T value;
+      Node* next;
+    };
+
+    public:
+      Mailbox() : m_head(nullptr) {}
+      ~Mailbox() { release(m_head.exchange(nullptr)); }
+
+      Mailbox(const Mailbox&) = delete;
+      Mailbox& operator=(const Mailbox&) = delete;
+
+      //! Posts a message. Safe to call from any number of threads.
+      void post(T value) {
+        Node* node = new Node{std::move(value),
+          m_head.load(std::memory_order_relaxed)};
+        while (!m_head.compare_exchange_weak(node->next, node,
+            std::memory_order_release, std::memory_order_relaxed)) {}
+      }
+
+      //! Hands every pending message to \p f in posting order.
+      /*!
+      *  Must only be called by the owning (consumer) thread.
+      *  \returns The number of messages received.
+      */
+      template <typename Func>
+      size_t receive(Func f) {
+        Node* node = m_head.exchange(nullptr, std::memory_order_acquire);
+
+        // The stack is LIFO; reverse it to deliver in posting order.
+        Node* ordered = nullptr;
+        while (node) {
+          Node* next = node->next;
+          node->next = ordered;
+          ordered = node;
+          node = next;
+        }
+
+        size_t count = 0;
+        while (ordered) {
+          Node* next = ordered->next;
+          f(std::move(ordered->value));
+          delete ordered;
+          ordered = next;
+          count++;
+        }
+        return count;
+      }
+
+      //! Discards every pending message. Same restriction as receive().
+      void clear() {
+        release(m_head.exchange(nullptr, std::memory_order_acquire));
+      }
+
+      bool empty() const {
+        return m_head.load(std::memory_order_relaxed) == nullptr;
+      }
+
+    private:
+      static void release(Node* node) {
+        while (node) {
+          Node* next = node->next;
+          delete node;
+          node = next;
+        }
+      }
+
+    private:
+      std::atomic<Node*> m_head;
+  };
+}
+
+#endif
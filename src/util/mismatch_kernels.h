@@ -0,0 +1,241 @@
+#ifndef MISMATCH_KERNELS_H
+#define MISMATCH_KERNELS_H
+
+#include <string>
+#include <vector>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PR_MISMATCH_X86 1
+#endif
+
+namespace pr {
+
+  //! Instruction sets the mismatch kernels are compiled for.
+  enum class Isa { Scalar, SSE2, AVX2, AVX512 };
+
+  //! Candidates compared against the target per kernel call.
+  static const size_t MismatchBatch = 4;
+
+  //! Counts, for each of \p count samples, the positions in [0, n) where
+  //! it differs from \p target. Elements are compared bitwise.
+  using MismatchFn = void (*)(const void* target, const void* const* samples,
+    size_t count, size_t n, size_t* out);
+
+  //! Element types the kernels handle: integers of one or four bytes, for
+  //! which bitwise and value equality agree.
+  template <typename T>
+  struct is_simd_comparable : std::integral_constant<bool,
+    std::is_integral<T>::value && !std::is_same<T, bool>::value &&
+    (sizeof(T) == 1 || sizeof(T) == 4)> {};
+
+  //! Fallback for containers the kernels can read directly.
+  template <typename T>
+  struct is_simd_container : std::false_type {};
+
+  //! Contiguous containers of simd-comparable elements.
+  template <typename C, typename... Ts>
+  struct is_simd_container<std::basic_string<C, Ts...>> : 
+    is_simd_comparable<C> {};
+
+  template <typename T, typename A>
+  struct is_simd_container<std::vector<T, A>> : is_simd_comparable<T> {};
+
+  template <typename T, size_t N>
+  struct is_simd_container<std::array<T, N>> : is_simd_comparable<T> {};
+
+  //! Compare-and-popcount kernels, one per instruction set.
+  /*!
+  *  Every kernel walks the target once and compares each block of it
+  *  against all samples of the batch while it is in a register. Blocks
+  *  give a mask of equal lanes, and the mismatches are the lanes it
+  *  leaves out. The remainder that does not fill a block is compared
+  *  element by element.
+  *  \tparam Size Element size in bytes, 1 or 4.
+  */
+  template <size_t Size>
+  struct MismatchKernels {
+
+    using Element = typename std::conditional<Size == 1, uint8_t,
+      uint32_t>::type;
+
+    static void scalar(const void* target, const void* const* samples,
+        size_t count, size_t n, size_t* out) {
+      scalarFrom(target, samples, count, 0, n, out, false);
+    }
+
+#ifdef PR_MISMATCH_X86
+    //! SSE2 has no popcount, so equal lanes are summed in registers: the
+    //! all-ones compare result is subtracted from per-lane counters, which
+    //! psadbw folds into 64-bit totals before a byte counter can overflow.
+    __attribute__((target("sse2")))
+    static void sse2(const void* target, const void* const* samples,
+        size_t count, size_t n, size_t* out) {
+      const size_t lanes = 16 / Size;
+      const uint8_t* t = static_cast<const uint8_t*>(target);
+      const __m128i zero = _mm_setzero_si128();
+      __m128i acc[MismatchBatch];
+      __m128i total[MismatchBatch];
+      size_t i = 0;
+      size_t blocks = 0;
+
+      for (size_t s = 0; s < count; s++) {
+        acc[s] = zero;
+        total[s] = zero;
+      }
+      for (; i + lanes <= n; i += lanes) {
+        __m128i a = _mm_loadu_si128(
+          reinterpret_cast<const __m128i*>(t + i * Size));
+        for (size_t s = 0; s < count; s++) {
+          __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(
+            static_cast<const uint8_t*>(samples[s]) + i * Size));
+          acc[s] = Size == 1 ?
+            _mm_sub_epi8(acc[s], _mm_cmpeq_epi8(a, b)) :
+            _mm_sub_epi32(acc[s], _mm_cmpeq_epi32(a, b));
+        }
+        if (Size == 1 && ++blocks == 255) {
+          for (size_t s = 0; s < count; s++) {
+            total[s] = _mm_add_epi64(total[s], _mm_sad_epu8(acc[s], zero));
+            acc[s] = zero;
+          }
+          blocks = 0;
+        }
+      }
+
+      for (size_t s = 0; s < count; s++) {
+        uint64_t sums[2];
+        if (Size == 1) {
+          total[s] = _mm_add_epi64(total[s], _mm_sad_epu8(acc[s], zero));
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(sums), total[s]);
+          out[s] = i - (sums[0] + sums[1]);
+        } else {
+          uint32_t lanes32[4];
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes32), acc[s]);
+          out[s] = i - (lanes32[0] + lanes32[1] + lanes32[2] + lanes32[3]);
+        }
+      }
+      scalarFrom(target, samples, count, i, n, out, true);
+    }
+
+    __attribute__((target("avx2,popcnt")))
+    static void avx2(const void* target, const void* const* samples,
+        size_t count, size_t n, size_t* out) {
+      const size_t lanes = 32 / Size;
+      const uint8_t* t = static_cast<const uint8_t*>(target);
+      size_t i = 0;
+
+      for (size_t s = 0; s < count; s++) {
+        out[s] = 0;
+      }
+      for (; i + lanes <= n; i += lanes) {
+        __m256i a = _mm256_loadu_si256(
+          reinterpret_cast<const __m256i*>(t + i * Size));
+        for (size_t s = 0; s < count; s++) {
+          __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(
+            static_cast<const uint8_t*>(samples[s]) + i * Size));
+          unsigned equal = Size == 1 ?
+            static_cast<unsigned>(_mm256_movemask_epi8(
+              _mm256_cmpeq_epi8(a, b))) :
+            static_cast<unsigned>(_mm256_movemask_ps(
+              _mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b))));
+          out[s] += lanes - __builtin_popcount(equal);
+        }
+      }
+      scalarFrom(target, samples, count, i, n, out, true);
+    }
+
+    __attribute__((target("avx512f,avx512bw,popcnt")))
+    static void avx512(const void* target, const void* const* samples,
+        size_t count, size_t n, size_t* out) {
+      const size_t lanes = 64 / Size;
+      const uint8_t* t = static_cast<const uint8_t*>(target);
+      size_t i = 0;
+
+      for (size_t s = 0; s < count; s++) {
+        out[s] = 0;
+      }
+      for (; i + lanes <= n; i += lanes) {
+        __m512i a = _mm512_loadu_si512(t + i * Size);
+        for (size_t s = 0; s < count; s++) {
+          __m512i b = _mm512_loadu_si512(
+            static_cast<const uint8_t*>(samples[s]) + i * Size);
+          uint64_t differ = Size == 1 ?
+            static_cast<uint64_t>(_mm512_cmpneq_epi8_mask(a, b)) :
+            static_cast<uint64_t>(_mm512_cmpneq_epi32_mask(a, b));
+          out[s] += __builtin_popcountll(differ);
+        }
+      }
+      scalarFrom(target, samples, count, i, n, out, true);
+    }
+#endif
+
+    //! The kernel for \p isa, or the scalar one if it was not compiled.
+    static MismatchFn get(Isa isa) {
+#ifdef PR_MISMATCH_X86
+      switch (isa) {
+        case Isa::AVX512: return &avx512;
+        case Isa::AVX2: return &avx2;
+        case Isa::SSE2: return &sse2;
+        default: break;
+      }
+#endif
+      return &scalar;
+    }
+
+    private:
+      static void scalarFrom(const void* target, const void* const* samples,
+          size_t count, size_t first, size_t n, size_t* out, bool add) {
+        const Element* t = static_cast<const Element*>(target);
+        for (size_t s = 0; s < count; s++) {
+          const Element* b = static_cast<const Element*>(samples[s]);
+          size_t differ = 0;
+          for (size_t i = first; i < n; i++) {
+            differ += t[i] != b[i];
+          }
+          out[s] = add ? out[s] + differ : differ;
+        }
+      }
+  };
+
+  //! Widest instruction set the running CPU supports.
+  inline Isa detectIsa() {
+#ifdef PR_MISMATCH_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512bw")) {
+      return Isa::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+      return Isa::AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+      return Isa::SSE2;
+    }
+#endif
+    return Isa::Scalar;
+  }
+
+  //! The kernel for elements of type T on this CPU, picked on first use.
+  template <typename T>
+  MismatchFn mismatchKernel() {
+    static_assert(is_simd_comparable<T>::value,
+        "Mismatch kernels need 1 or 4 byte integers.");
+    static const MismatchFn kernel =
+      MismatchKernels<sizeof(T)>::get(detectIsa());
+    return kernel;
+  }
+
+  //! Number of positions in [0, n) where \p a and \p b differ.
+  template <typename T>
+  size_t countMismatches(const T* a, const T* b, size_t n) {
+    const void* samples[1] = { b };
+    size_t out;
+    mismatchKernel<T>()(a, samples, 1, n, &out);
+    return out;
+  }
+}
+
+#endif
@@ -0,0 +1,161 @@
+#ifndef PROCESS_WORKER_H
+#define PROCESS_WORKER_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstddef>
+#include <cerrno>
+#include <type_traits>
+#include <unistd.h>
+#include <sys/mman.h>
+
+namespace pr {
+
+  //! Environment variable that passes the shared memory descriptor to
+  //! worker processes.
+  static const char* const ProcessShmVariable = "PROGENY_SHM_FD";
+
+  //! Header at the start of the memory shared with worker processes.
+  /*!
+  *  The region holds a ring of batch slots after a one page header. Each
+  *  slot starts with the number of genomes it holds, followed by room for
+  *  capacity genomes and capacity fitness values, both at fixed offsets.
+  *  Genomes and fitness values are stored as raw bytes, so both types
+  *  must be trivially copyable and laid out the same in every process.
+  */
+  struct ProcessLayout {
+    static const uint64_t Magic = 0x7072676e79736d31ull;
+    static const size_t HeaderSize = 4096;
+
+    uint64_t magic;
+    uint64_t genomeSize;
+    uint64_t fitnessSize;
+    uint64_t capacity;
+    uint64_t slots;
+    uint64_t slotSize;
+    uint64_t genomeOffset;
+    uint64_t fitnessOffset;
+
+    ProcessLayout() = default;
+
+    ProcessLayout(size_t genome, size_t fitness, size_t batch, size_t count) :
+      magic(Magic), genomeSize(genome), fitnessSize(fitness),
+      capacity(batch), slots(count), genomeOffset(64),
+      fitnessOffset(align(64 + genome * batch)) {
+      slotSize = align(fitnessOffset + fitness * batch);
+    }
+
+    size_t size() const {
+      return HeaderSize + slots * slotSize;
+    }
+
+    char* slot(char* region, size_t s) const {
+      return region + HeaderSize + s * slotSize;
+    }
+
+    static uint64_t align(uint64_t bytes) {
+      return (bytes + 63) & ~uint64_t(63);
+    }
+  };
+
+  //! Reads exactly \p size bytes, retrying on interrupts. False at EOF.
+  inline bool readFully(int fd, void* data, size_t size) {
+    char* p = static_cast<char*>(data);
+    while (size > 0) {
+      ssize_t n = ::read(fd, p, size);
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+      if (n <= 0) {
+        return false;
+      }
+      p += n;
+      size -= n;
+    }
+    return true;
+  }
+
+  inline bool writeFully(int fd, const void* data, size_t size) {
+    const char* p = static_cast<const char*>(data);
+    while (size > 0) {
+      ssize_t n = ::write(fd, p, size);
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+      if (n <= 0) {
+        return false;
+      }
+      p += n;
+      size -= n;
+    }
+    return true;
+  }
+
+  //! Serves batches for a ProcessEvaluator; the main loop of a worker.
+  /*!
+  *  The evaluator starts the worker with the shared memory descriptor in
+  *  PROGENY_SHM_FD and a socket on stdin and stdout. Each request is the
+  *  32-bit index of a slot; the worker scores the genomes in that slot,
+  *  writes the fitness values next to them and echoes the index back.
+  *  Only slot indices cross the socket, the data stays in place, and the
+  *  socket round trip orders the memory accesses of both sides.
+  *
+  *  A worker must not write anything else to stdout. A crash or exit
+  *  while a batch is pending makes the evaluator requeue that batch on a
+  *  fresh worker.
+  *  \tparam BaseType The genome type, as in the evaluator's candidates.
+  *  \tparam FitnessType The fitness type, as in the evaluator's candidates.
+  *  \param score Called as score(genomes, count, fitness) per batch.
+  *  \returns The exit status for main(): 0 once the evaluator hangs up,
+  *  1 if the shared memory does not match the template arguments.
+  */
+  template <typename BaseType, typename FitnessType, typename FType>
+  int serveWorker(FType score) {
+    static_assert(std::is_trivially_copyable<BaseType>::value &&
+        std::is_trivially_copyable<FitnessType>::value,
+        "Genomes and fitness values must be trivially copyable.");
+
+    const char* env = std::getenv(ProcessShmVariable);
+    if (!env) {
+      return 1;
+    }
+    int fd = std::atoi(env);
+
+    ProcessLayout layout;
+    if (::pread(fd, &layout, sizeof(layout), 0) != sizeof(layout) ||
+        layout.magic != ProcessLayout::Magic ||
+        layout.genomeSize != sizeof(BaseType) ||
+        layout.fitnessSize != sizeof(FitnessType)) {
+      return 1;
+    }
+
+    void* map = ::mmap(nullptr, layout.size(), PROT_READ | PROT_WRITE,
+      MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+      return 1;
+    }
+    char* region = static_cast<char*>(map);
+
+    uint32_t s;
+    while (readFully(STDIN_FILENO, &s, sizeof(s))) {
+      if (s >= layout.slots) {
+        return 1;
+      }
+
+      char* slot = layout.slot(region, s);
+      uint64_t count = *reinterpret_cast<uint64_t*>(slot);
+      score(reinterpret_cast<const BaseType*>(slot + layout.genomeOffset),
+        static_cast<size_t>(count),
+        reinterpret_cast<FitnessType*>(slot + layout.fitnessOffset));
+
+      if (!writeFully(STDOUT_FILENO, &s, sizeof(s))) {
+        break;
+      }
+    }
+
+    ::munmap(map, layout.size());
+    return 0;
+  }
+}
+
+#endif
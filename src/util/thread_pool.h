@@ -0,0 +1,76 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <thread>
+#include <future>
+#include <memory>
+#include <functional>
+#include <type_traits>
+
+#include "bounded_queue.h"
+
+namespace pr {
+
+  //! Fixed set of worker threads running submitted tasks in FIFO order.
+  /*!
+  *  Meant to be shared between simulations started with evolveAsync(), so
+  *  that concurrent runs are bounded by the pool size instead of each one
+  *  bringing its own threads. The destructor finishes the queued tasks
+  *  before joining the workers.
+  */
+  class ThreadPool {
+
+    public:
+      /*!
+      *  \param threads Number of worker threads.
+      *  \param capacity Queued tasks after which submit() blocks.
+      */
+      explicit ThreadPool(size_t threads, size_t capacity = 1024) :
+        m_tasks(capacity) {
+        for (size_t t = 0; t < threads; t++) {
+          m_workers.emplace_back(&ThreadPool::work, this);
+        }
+      }
+
+      ThreadPool(const ThreadPool&) = delete;
+      ThreadPool& operator=(const ThreadPool&) = delete;
+
+      ~ThreadPool() {
+        m_tasks.close();
+        for (auto& w : m_workers) {
+          w.join();
+        }
+      }
+
+      //! Queues \p f and returns a future for its result.
+      template <typename FType>
+      std::future<typename std::result_of<FType()>::type> submit(FType f) {
+        using RType = typename std::result_of<FType()>::type;
+
+        // std::function needs a copyable target, packaged_task is not.
+        auto task = std::make_shared<std::packaged_task<RType()>>(f);
+        std::future<RType> result = task->get_future();
+        m_tasks.push([task]{ (*task)(); });
+        return result;
+      }
+
+      size_t size() const {
+        return m_workers.size();
+      }
+
+    private:
+      void work() {
+        std::function<void()> task;
+        while (m_tasks.pop(task)) {
+          task();
+        }
+      }
+
+    private:
+      BoundedQueue<std::function<void()>> m_tasks;
+      std::vector<std::thread> m_workers;
+  };
+}
+
+#endif
@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <vector>
+#include <future>
+#include <algorithm>
+
+#include "../src/core/simulation.h"
+#include "../src/util/thread_pool.h"
+
+#include "../src/evaluators/mismatch_evaluator.h"
+#include "../src/generators/fill_generator.h"
+#include "../src/selectors/roulette_selector.h"
+#include "../src/mutators/pass_through.h"
+#include "../src/mutators/crossover.h"
+
+TEST(ThreadPool, Submit) {
+  pr::ThreadPool pool(3);
+  std::atomic<int> count(0);
+
+  std::vector<std::future<int>> results;
+  for (int i = 0; i < 100; i++) {
+    results.push_back(pool.submit([i, &count]{
+      count++;
+      return i * i;
+    }));
+  }
+
+  for (int i = 0; i < 100; i++) {
+    EXPECT_EQ(results[i].get(), i * i);
+  }
+  EXPECT_EQ(count, 100);
+}
+
+TEST(Simulation, EvolveAsync) {
+  using Candidate = pr::Candidate<std::string, double>;
+  using Population = pr::Population<Candidate>;
+
+  auto build = []{
+    pr::FillGenerator<Candidate> fg([]{ return std::string("aaaaaaaa"); });
+    pr::MismatchEvaluator<Candidate> mev("unreachable target");
+    pr::RouletteSelector<Candidate> rs;
+    auto mut = pr::Crossover<Candidate>(2) >> pr::PassThrough<Candidate>();
+    return pr::Simulation<Candidate>::build(fg, mev, rs, mut);
+  };
+
+  // The breakpoint never fires, so only cancellation ends these runs.
+  auto never = [](const Population&, Candidate&) { return false; };
+
+  pr::ThreadPool pool(2);
+  auto a = build();
+  auto b = build();
+  auto ha = a.evolveAsync(100, 10, never, pool);
+  auto hb = b.evolveAsync(100, 10, never, pool);
+
+  while (ha.generation() < 3 || hb.generation() < 3) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_FALSE(ha.ready());
+
+  ha.cancel();
+  hb.cancel();
+  Candidate ea = ha.get();
+  Candidate eb = hb.get();
+
+  EXPECT_TRUE(ha.cancelled());
+  EXPECT_EQ(pr::progeny(ea).size() > 0, true);
+  EXPECT_EQ(pr::fitness(ea), pr::fitness(ha.best()));
+  EXPECT_EQ(pr::fitness(eb), pr::fitness(hb.best()));
+
+  // A run on its own thread behaves the same way.
+  auto c = build();
+  auto hc = c.evolveAsync(100, 10, never);
+  while (hc.generation() < 1) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  hc.cancel();
+  Candidate ec = hc.get();
+  EXPECT_EQ(pr::fitness(ec), pr::fitness(hc.best()));
+}
@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <string>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include "../src/core/simulation.h"
+#include "../src/core/checkpoint.h"
+
+#include "../src/evaluators/mismatch_evaluator.h"
+#include "../src/generators/fill_generator.h"
+#include "../src/selectors/roulette_selector.h"
+#include "../src/mutators/pass_through.h"
+#include "../src/mutators/crossover.h"
+
+TEST(Checkpoint, MappedRoundTrip) {
+  using Candidate = pr::Candidate<std::array<int, 4>, int>;
+
+  pr::Checkpoint<Candidate> out;
+  out.generation = 12;
+  out.evaluations = 340;
+  out.elapsedTime = 1.5;
+  out.state = "opaque";
+  for (int i = 0; i < 100; i++) {
+    out.population.push_back(Candidate({{i, i + 1, i + 2, i + 3}}, i * 2));
+    out.population.back().alive = (i % 3 != 0);
+  }
+
+  std::string path = "checkpoint_mapped.prck";
+  out.write(path);
+
+  pr::Checkpoint<Candidate> in;
+  in.read(path);
+  std::remove(path.c_str());
+
+  EXPECT_EQ(in.generation, 12);
+  EXPECT_EQ(in.evaluations, 340);
+  EXPECT_EQ(in.elapsedTime, 1.5);
+  EXPECT_EQ(in.state, "opaque");
+  ASSERT_EQ(in.population.size(), 100);
+  for (int i = 0; i < 100; i++) {
+    EXPECT_EQ(pr::progeny(in.population[i]), pr::progeny(out.population[i]));
+    EXPECT_EQ(pr::fitness(in.population[i]), i * 2);
+    EXPECT_EQ(in.population[i].alive, (i % 3 != 0));
+  }
+}
+
+TEST(Checkpoint, MappedBounds) {
+  using Candidate = pr::Candidate<std::array<int, 4>, int>;
+
+  pr::Checkpoint<Candidate> out;
+  out.state = "opaque";
+  for (int i = 0; i < 100; i++) {
+    out.population.push_back(Candidate({{i, i, i, i}}, i));
+  }
+
+  std::string path = "checkpoint_bounds.prck";
+  out.write(path);
+  std::string bytes;
+  {
+    std::ifstream is(path, std::ios::binary);
+    bytes.assign(std::istreambuf_iterator<char>(is), 
+      std::istreambuf_iterator<char>());
+  }
+  auto rewrite = [&path](const std::string& data) {
+    std::ofstream os(path, std::ios::binary | std::ios::trunc);
+    os.write(data.data(), data.size());
+  };
+
+  // A state size reaching past the end of the file, at its header offset.
+  std::string corrupt = bytes;
+  uint64_t huge = uint64_t(1) << 62;
+  std::memcpy(&corrupt[72], &huge, sizeof(huge));
+  rewrite(corrupt);
+  pr::Checkpoint<Candidate> in;
+  EXPECT_THROW(in.read(path), std::runtime_error);
+
+  // A file cut short inside the genome block.
+  rewrite(bytes.substr(0, bytes.size() - 1));
+  EXPECT_THROW(in.read(path), std::runtime_error);
+
+  rewrite(bytes);
+  in.read(path);
+  std::remove(path.c_str());
+  EXPECT_EQ(in.state, "opaque");
+}
+
+TEST(Checkpoint, ParsedBounds) {
+  using Candidate = pr::Candidate<std::string, int>;
+
+  pr::Checkpoint<Candidate> out;
+  out.state = "opaque";
+  for (int i = 0; i < 100; i++) {
+    out.population.push_back(Candidate(std::string(8, 'a' + i % 26), i));
+  }
+
+  std::string path = "checkpoint_parsed.prck";
+  out.write(path);
+  std::string bytes;
+  {
+    std::ifstream is(path, std::ios::binary);
+    bytes.assign(std::istreambuf_iterator<char>(is), 
+      std::istreambuf_iterator<char>());
+  }
+  auto rewrite = [&path](const std::string& data) {
+    std::ofstream os(path, std::ios::binary | std::ios::trunc);
+    os.write(data.data(), data.size());
+  };
+  uint64_t huge = uint64_t(1) << 62;
+  uint64_t genomes;
+  std::memcpy(&genomes, &bytes[80], sizeof(genomes));
+
+  // Corrupt sizes must surface as runtime errors, never as an allocation
+  // of whatever the file claims. First the member count, then the state
+  // size, then the length prefix of the first genome.
+  for (size_t offset : { size_t(24), size_t(72), size_t(genomes) }) {
+    std::string corrupt = bytes;
+    std::memcpy(&corrupt[offset], &huge, sizeof(huge));
+    rewrite(corrupt);
+    pr::Checkpoint<Candidate> in;
+    EXPECT_THROW(in.read(path), std::runtime_error) << offset;
+  }
+
+  // A file cut short inside the genome block.
+  rewrite(bytes.substr(0, bytes.size() - 1));
+  pr::Checkpoint<Candidate> in;
+  EXPECT_THROW(in.read(path), std::runtime_error);
+
+  rewrite(bytes);
+  in.read(path);
+  std::remove(path.c_str());
+  EXPECT_EQ(in.state, "opaque");
+  ASSERT_EQ(in.population.size(), 100);
+  EXPECT_EQ(pr::progeny(in.population[99]), std::string(8, 'a' + 99 % 26));
+}
+
+TEST(Checkpoint, Resume) {
+  using Candidate = pr::Candidate<std::string, double>;
+  using Population = pr::Population<Candidate>;
+
+  // Regenerated members are constant so that every source of randomness
+  // lives in operators that checkpoint their state.
+  auto build = []{
+    pr::FillGenerator<Candidate> fg([]{ return std::string("aaaaaa"); });
+    pr::MismatchEvaluator<Candidate> mev("kernel");
+    pr::RouletteSelector<Candidate> rs;
+    auto mut = pr::Crossover<Candidate>(2) >> pr::PassThrough<Candidate>();
+    return pr::Simulation<Candidate>::build(fg, mev, rs, mut);
+  };
+
+  Population seed{
+    "kaaaaa", "aeaaaa", "aarnel", "kernaa", "aaaaal", "keaaaa", "aarnaa",
+    "kxrnxl", "xexnel", "kerxex", "aarnea", "kaanel"
+  };
+
+  auto until = [](size_t gens) {
+    size_t count = 0;
+    return [gens, count](const Population&, Candidate&) mutable {
+      return ++count >= gens;
+    };
+  };
+
+  std::string path = "checkpoint_resume.prck";
+
+  // The uninterrupted run checkpoints after generation 5 and stops at 8.
+  auto a = build();
+  a.checkpoint(path, 5);
+  a.evolve(12, 4, seed, until(8));
+
+  // A fresh simulation picks up at generation 5 and runs 3 more.
+  auto b = build();
+  b.resume(path, 4, until(3));
+  std::remove(path.c_str());
+
+  ASSERT_EQ(a.population().size(), b.population().size());
+  for (size_t i = 0; i < a.population().size(); i++) {
+    EXPECT_EQ(pr::progeny(a.population()[i]), pr::progeny(b.population()[i]));
+    EXPECT_EQ(pr::fitness(a.population()[i]), pr::fitness(b.population()[i]));
+  }
+}
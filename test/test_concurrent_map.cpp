@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <omp.h>
+
+#include "../src/util/concurrent_map.h"
+
+TEST(ConcurrentMap, Clock) {
+  // A single shard makes the eviction order predictable.
+  pr::ConcurrentMap<int, std::string> map(3, 1);
+  map.insert(1, "one");
+  map.insert(2, "two");
+  map.insert(3, "three");
+
+  // 1 is referenced, so the clock hand passes it over and evicts 2.
+  std::string value;
+  EXPECT_TRUE(map.find(1, value));
+  EXPECT_EQ(value, "one");
+  map.insert(4, "four");
+
+  EXPECT_TRUE(map.find(1, value));
+  EXPECT_FALSE(map.find(2, value));
+  EXPECT_TRUE(map.find(3, value));
+  EXPECT_TRUE(map.find(4, value));
+  EXPECT_EQ(value, "four");
+
+  auto stats = map.stats();
+  EXPECT_EQ(stats.hits, 4u);
+  EXPECT_EQ(stats.misses, 1u);
+  EXPECT_EQ(stats.evictions, 1u);
+  EXPECT_EQ(stats.entries, 3u);
+}
+
+TEST(ConcurrentMap, Parallel) {
+  pr::ConcurrentMap<int, int> map(1 << 12, 16);
+  size_t capacity = map.capacity();
+  EXPECT_GE(capacity, 1u << 12);
+
+  #pragma omp parallel for num_threads(4)
+  for (int i = 0; i < 20000; i++) {
+    int value;
+    if (map.find(i % 5000, value)) {
+      EXPECT_EQ(value, 2 * (i % 5000));
+    } else {
+      map.insert(i % 5000, 2 * (i % 5000));
+    }
+  }
+
+  auto stats = map.stats();
+  EXPECT_EQ(stats.hits + stats.misses, 20000u);
+  EXPECT_LE(stats.entries, capacity);
+  EXPECT_GT(stats.evictions, 0u);
+}
@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+
+#ifdef PROGENY_TEST_MPI
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <boost/mpi.hpp>
+#include <boost/serialization/string.hpp>
+
+#include "../src/core/simulation.h"
+#include "../src/core/distributed_simulation.h"
+#include "../src/core/objectives.h"
+
+#include "../src/generators/fill_generator.h"
+#include "../src/selectors/nsga_selector.h"
+#include "../src/mutators/pass_through.h"
+#include "../src/mutators/point.h"
+
+namespace {
+
+  using Fitness = pr::Objectives<int, 2>;
+  using Candidate = pr::Candidate<std::string, Fitness>;
+
+  //! Mismatched letters of the first and second half of "mpi!".
+  class Halves : public pr::Evaluator<Candidate> {
+    public:
+      void evaluate(pr::Population<Candidate>& pop) {
+        for (size_t i : pr::stale(pop)) {
+          const std::string& s = pr::progeny(pop[i]);
+          pr::fitness(pop[i]) = { (s[0] != 'm') + (s[1] != 'p'),
+            (s[2] != 'i') + (s[3] != '!') };
+          pop[i].valid = true;
+        }
+      }
+  };
+}
+
+// A single rank runs every migration point: the sends are skipped, but
+// the probes, reductions and the closing drain all go through MPI, here
+// with a fitness that is not arithmetic.
+TEST(Distributed, SingleRank) {
+  boost::mpi::environment env;
+  boost::mpi::communicator world;
+  ASSERT_EQ(world.size(), 1);
+
+  using Population = pr::Population<Candidate>;
+
+  const std::string target = "mpi!";
+  std::vector<char> letters{ 'm', 'p', 'i', '!', 'x' };
+
+  pr::FillGenerator<Candidate> fg([]{ return std::string(4, 'x'); });
+  Halves ev;
+  pr::NSGASelector<Candidate> ns;
+  auto mut = pr::Point<Candidate>(letters, 0.3) >>
+    pr::PassThrough<Candidate>();
+
+  pr::DistributedSimulation<
+    decltype(fg), decltype(ev), decltype(ns), decltype(mut), Candidate
+  > sim(world, fg, ev, ns, mut);
+  sim.migration(pr::Topology::Ring, 1, 2);
+
+  Candidate result = sim.evolve(50, 10, [&](const Population& pop,
+      Candidate& elite) {
+    auto match = std::find_if(pop.begin(), pop.end(), [&](const Candidate& c){
+      return pr::progeny(c) == target;
+    });
+    if (match != pop.end()) {
+      elite = *match;
+      return true;
+    }
+    return false;
+  });
+
+  EXPECT_EQ(pr::progeny(result), target);
+  EXPECT_EQ(sim.globalBest(), 0.0);
+}
+#endif
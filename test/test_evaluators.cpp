@@ -3,11 +3,25 @@
 #include <map>
 #include <iostream>
 #include <string>
+#include <sstream>
+#include <atomic>
+#include <random>
+#include <set>
+#include <numeric>
 
 #include "../src/core/population.h"
 #include "../src/evaluators/null_evaluator.h"
 #include "../src/evaluators/mismatch_evaluator.h"
 #include "../src/evaluators/competitive_evaluator.h"
+#include "../src/evaluators/caching_evaluator.h"
+#include "../src/evaluators/hamming_evaluator.h"
+#include "../src/evaluators/batch_evaluator.h"
+#include "../src/evaluators/process_evaluator.h"
+#include "../src/evaluators/surrogate_evaluator.h"
+#include "../src/evaluators/queens_evaluator.h"
+#include "../src/mutators/point.h"
+#include "../src/mutators/crossover.h"
+#include "../src/util/mismatch_kernels.h"
 
 template <typename T>
 class MismatchTest : public testing::Test {
@@ -118,3 +132,550 @@ TEST(Evaluators, CompetitiveEvaluator) {
   }
 
 }
+
+TEST(Evaluators, HammingEvaluator) {
+  using Bits = pr::BitString<70>;
+  using Candidate = pr::Candidate<Bits, int>;
+  using Population = pr::Population<Candidate>;
+
+  Bits some(std::string(35, '1'));
+  EXPECT_EQ(Bits::ones().count(), 70);
+  EXPECT_EQ(some.toString(), std::string(35, '1') + std::string(35, '0'));
+
+  Population pop{ Bits(), Bits::ones(), some };
+  pr::HammingEvaluator<Candidate> onemax(Bits::ones());
+  onemax.evaluate(pop);
+
+  EXPECT_EQ(pr::fitness(pop[0]), 70);
+  EXPECT_EQ(pr::fitness(pop[1]), 0);
+  EXPECT_EQ(pr::fitness(pop[2]), 35);
+  EXPECT_TRUE(pop[2].valid);
+}
+
+TEST(Evaluators, CompetitiveRatings) {
+  using Candidate = pr::Candidate<int, double>;
+  using Population = pr::Population<Candidate>;
+  using Evaluator = pr::CompetitiveEvaluator<Candidate, 2>;
+
+  // Groups that do not fill up are skipped instead of wrapping around.
+  Population few{ 1 };
+  pr::CompetitiveEvaluator<Candidate, 3>([](Population::iterator, 
+      Population::iterator) { ADD_FAILURE(); }).evaluate(few);
+
+  // Seven rounds of a round robin over eight members meet every pair once.
+  std::vector<size_t> groups;
+  std::set<std::pair<size_t, size_t>> met;
+  pr::RandomStream stream;
+  for (size_t r = 0; r < 7; r++) {
+    pr::RoundRobinPairing<2>().pair(8, r, {}, stream, groups);
+    EXPECT_EQ(groups.size(), 8);
+    for (size_t g = 0; g < groups.size(); g += 2) {
+      met.emplace(std::min(groups[g], groups[g + 1]), 
+        std::max(groups[g], groups[g + 1]));
+    }
+  }
+  EXPECT_EQ(met.size(), 28);
+
+  // The larger progeny wins, so ratings end up in the same order.
+  auto match = [](const Evaluator::Group& g) {
+    return Evaluator::Scores{{ 
+      double(pr::progeny(*g[0])), double(pr::progeny(*g[1])) }};
+  };
+  Population pop{ 3, 7, 1, 5, 2, 8, 4, 6, 0 };
+  Evaluator swiss(match, pr::SwissPairing<2>(), 20);
+  swiss.evaluate(pop);
+  Evaluator random(match, pr::RandomOpponentsPairing<2>(3), 20);
+  random.evaluate(pop);
+
+  std::sort(pop.begin(), pop.end(), [](const Candidate& a, 
+      const Candidate& b) {
+    return pr::fitness(a) < pr::fitness(b);
+  });
+  for (size_t i = 0; i < pop.size(); i++) {
+    EXPECT_EQ(pr::progeny(pop[i]), 8 - static_cast<int>(i));
+    EXPECT_TRUE(pop[i].valid);
+  }
+
+  // Ranges only read the rounds, which move on once per generation.
+  auto state = [](const Evaluator& e) {
+    std::ostringstream os;
+    e.saveState(os);
+    return os.str();
+  };
+  Evaluator whole(match, pr::ShuffledPairing<2>(), 3);
+  Evaluator ranged = whole;
+  whole.evaluate(pop);
+  std::string before = state(ranged);
+  ranged.evaluateRange(pop, 0, 4);
+  ranged.evaluateRange(pop, 4, pop.size());
+  EXPECT_EQ(state(ranged), before);
+  pr::nextGeneration(ranged);
+  EXPECT_EQ(state(ranged), state(whole));
+}
+
+TEST(Evaluators, BatchEvaluator) {
+  using Candidate = pr::Candidate<std::array<double, 3>, double>;
+  using Population = pr::Population<Candidate>;
+
+  Population pop(50);
+  for (size_t i = 0; i < pop.size(); i++) {
+    pr::progeny(pop[i]) = {{ double(i), 2.0 * i, 1.0 }};
+    pop[i].valid = i % 5 == 0;
+  }
+
+  // Scores the sum of the genes, reading them gene by gene.
+  std::atomic<size_t> scored(0);
+  pr::BatchEvaluator<Candidate> batches([&](const pr::Batch<double>& batch,
+      double* fitness) {
+    EXPECT_LE(batch.size(), 16);
+    EXPECT_EQ(batch.stride(), 16);
+    EXPECT_EQ(batch.gene(2)[batch.size() - 1], 1.0);
+    EXPECT_EQ(batch.gene(2)[batch.stride() - 1], batch.size() == 16);
+    for (size_t b = 0; b < batch.size(); b++) {
+      fitness[b] = batch.gene(0)[b] + batch.gene(1)[b] + batch.gene(2)[b];
+    }
+    scored += batch.size();
+  }, 16);
+
+  batches.evaluate(pop);
+  EXPECT_EQ(scored, 40);
+  for (size_t i = 0; i < pop.size(); i++) {
+    EXPECT_EQ(pr::fitness(pop[i]), i % 5 == 0 ? 0.0 : 3.0 * i + 1);
+    EXPECT_TRUE(pop[i].valid);
+  }
+}
+
+#ifdef PROGENY_TEST_WORKER
+TEST(Evaluators, ProcessEvaluator) {
+  using Candidate = pr::Candidate<std::array<double, 8>, double>;
+  using Population = pr::Population<Candidate>;
+  using Evaluator = pr::ProcessEvaluator<Candidate>;
+
+  Population pop(500);
+  for (size_t i = 0; i < pop.size(); i++) {
+    pr::progeny(pop[i]).fill(double(i));
+  }
+
+  // Workers crashing on their third batch are replaced and the batch 
+  // they held is scored by the next one.
+  Evaluator steady({ PROGENY_TEST_WORKER }, 3, 16);
+  Evaluator crashing({ PROGENY_TEST_WORKER, "--crash", "3" }, 2, 16);
+  for (Evaluator* evaluator : { &steady, &crashing }) {
+    for (auto& cnd : pop) {
+      cnd.valid = false;
+    }
+    evaluator->evaluate(pop);
+    for (size_t i = 0; i < pop.size(); i++) {
+      EXPECT_EQ(pr::fitness(pop[i]), 8.0 * i);
+      EXPECT_TRUE(pop[i].valid);
+    }
+  }
+  EXPECT_EQ(steady.restarts(), 0);
+  EXPECT_GT(crashing.restarts(), 0);
+
+  // A batch that kills every worker is given up on.
+  pop[0].valid = false;
+  Evaluator hopeless({ PROGENY_TEST_WORKER, "--crash", "1" }, 2, 16, 2, 2);
+  EXPECT_THROW(hopeless.evaluate(pop), std::runtime_error);
+
+  // A call given up on while other workers still hold batches leaves no
+  // stale replies for the next one.
+  Evaluator fragile({ PROGENY_TEST_WORKER, "--crash", "3" }, 2, 16, 2, 0);
+  for (auto& cnd : pop) {
+    cnd.valid = false;
+  }
+  EXPECT_THROW(fragile.evaluate(pop), std::runtime_error);
+
+  Population small(16);
+  for (size_t i = 0; i < small.size(); i++) {
+    pr::progeny(small[i]).fill(double(i + 1000));
+  }
+  fragile.evaluate(small);
+  for (size_t i = 0; i < small.size(); i++) {
+    EXPECT_EQ(pr::fitness(small[i]), 8.0 * (i + 1000));
+    EXPECT_TRUE(small[i].valid);
+  }
+}
+#endif
+
+//! Scores a linear function of three genes, counting the calls.
+class LinearEvaluator : public pr::Evaluator<
+    pr::Candidate<std::array<double, 3>, double>> {
+
+  public:
+    LinearEvaluator(std::atomic<size_t>& calls) : m_calls(&calls) {}
+
+    void evaluate(Population& pop) {
+      for (size_t i : pr::stale(pop)) {
+        pr::fitness(pop[i]) = truth(pr::progeny(pop[i]));
+        pop[i].valid = true;
+        (*m_calls)++;
+      }
+    }
+
+    static double truth(const std::array<double, 3>& g) {
+      return 3 * g[0] - 2 * g[1] + g[2] + 5;
+    }
+
+  private:
+    std::atomic<size_t>* m_calls;
+};
+
+TEST(Evaluators, SurrogateEvaluator) {
+  using Genome = std::array<double, 3>;
+  using Candidate = pr::Candidate<Genome, double>;
+  using Population = pr::Population<Candidate>;
+  using Surrogate = pr::SurrogateEvaluator<Candidate, LinearEvaluator,
+    pr::LinearSurrogate<Genome>>;
+
+  std::mt19937 mt(7);
+  std::uniform_real_distribution<double> gene(-1, 1);
+  Population pop(100);
+  auto randomize = [&]() {
+    for (auto& cnd : pop) {
+      pr::progeny(cnd) = {{ gene(mt), gene(mt), gene(mt) }};
+      cnd.valid = false;
+    }
+  };
+
+  // The untrained model lets everybody through, then learns the linear
+  // fitness, up to the pull of its prior, and sends only the best quarter,
+  // the lowest predicted errors, on.
+  std::atomic<size_t> calls(0);
+  Surrogate surrogate(LinearEvaluator(calls),
+    pr::LinearSurrogate<Genome>(1.0), 0.25);
+  randomize();
+  surrogate.evaluate(pop);
+  EXPECT_EQ(calls, 100);
+
+  randomize();
+  surrogate.evaluate(pop);
+  EXPECT_EQ(calls, 125);
+  EXPECT_EQ(surrogate.estimates(), 75);
+
+  double worst_real = -1e9;
+  double best_estimated = 1e9;
+  for (auto& cnd : pop) {
+    double fitness = pr::fitness(cnd);
+    EXPECT_NEAR(fitness, LinearEvaluator::truth(pr::progeny(cnd)), 1e-3);
+    EXPECT_NE(cnd.valid, cnd.estimated);
+    if (cnd.estimated) {
+      best_estimated = std::min(best_estimated, fitness);
+    } else {
+      worst_real = std::max(worst_real, fitness);
+    }
+  }
+  EXPECT_LE(worst_real, best_estimated);
+
+  // The trained model and the counters survive a checkpoint.
+  std::stringstream state;
+  surrogate.saveState(state);
+  Surrogate resumed(LinearEvaluator(calls),
+    pr::LinearSurrogate<Genome>(1.0), 0.25);
+  resumed.loadState(state);
+  EXPECT_EQ(resumed.realEvaluations(), 125);
+  EXPECT_EQ(resumed.estimates(), 75);
+
+  randomize();
+  resumed.evaluate(pop);
+  EXPECT_EQ(calls, 150);
+
+  // Nearest neighbours reproduce a remembered genome exactly.
+  pr::KnnSurrogate<Genome> knn(2, 3);
+  knn.update({{ 0, 0, 0 }}, 1.0);
+  knn.update({{ 1, 0, 0 }}, 2.0);
+  EXPECT_TRUE(knn.ready());
+  EXPECT_EQ(knn.predict({{ 1, 0, 0 }}), 2.0);
+  EXPECT_NEAR(knn.predict({{ 0.5, 0, 0 }}), 1.5, 1e-12);
+}
+
+TEST(Evaluators, SurrogateOverMismatch) {
+  using Bits = std::array<int, 3>;
+  using Candidate = pr::Candidate<Bits, double>;
+  using Population = pr::Population<Candidate>;
+
+  // A model that knows every genome exactly, around a built-in error
+  // evaluator whose isNatural() keeps its default.
+  pr::KnnSurrogate<Bits> knn(1, 8);
+  Population pop;
+  for (int b = 0; b < 8; b++) {
+    Bits bits{{ b & 1, (b >> 1) & 1, (b >> 2) & 1 }};
+    knn.update(bits, (b & 1) + ((b >> 1) & 1) + ((b >> 2) & 1));
+    pop.push_back(Candidate(bits));
+  }
+
+  pr::SurrogateEvaluator<Candidate, pr::MismatchEvaluator<Candidate>,
+    pr::KnnSurrogate<Bits>> surrogate(
+      pr::MismatchEvaluator<Candidate>(Bits{{ 0, 0, 0 }}), knn, 0.5);
+  surrogate.evaluate(pop);
+
+  // The perfect genome and the three one bit off are evaluated for real.
+  for (auto& cnd : pop) {
+    EXPECT_EQ(cnd.estimated, pr::fitness(cnd) > 1) << pr::fitness(cnd);
+  }
+  EXPECT_EQ(surrogate.realEvaluations(), 4);
+}
+
+TEST(Evaluators, DeltaEvaluator) {
+  const int Q = 40;
+  using Board = std::array<int, Q>;
+  using Candidate = pr::Candidate<Board, int>;
+  using Population = pr::Population<Candidate>;
+
+  auto naive = [](const Board& board) {
+    int attacks = 0;
+    for (int c = 0; c < Q; c++) {
+      for (int adv = c + 1; adv < Q; adv++) {
+        int d = board[adv] - board[c];
+        attacks += d == 0 || d == adv - c || d == c - adv;
+      }
+    }
+    return attacks;
+  };
+
+  std::mt19937 mt(11);
+  std::uniform_int_distribution<int> row(0, Q - 1);
+  Population pop(200);
+  for (auto& cnd : pop) {
+    std::generate(pr::progeny(cnd).begin(), pr::progeny(cnd).end(),
+      [&]() { return row(mt); });
+    cnd.alive = true;
+  }
+
+  std::vector<int> rows(Q);
+  std::iota(rows.begin(), rows.end(), 0);
+  pr::Point<Candidate> point(rows, 1.0);
+  pr::QueensEvaluator<Candidate> queens;
+
+  // The first evaluation scores in full and starts tracking.
+  queens.evaluate(pop);
+  for (auto& cnd : pop) {
+    EXPECT_EQ(pr::fitness(cnd), naive(pr::progeny(cnd)));
+    EXPECT_TRUE(cnd.changes.tracked());
+    EXPECT_EQ(cnd.changes.size(), 0);
+  }
+
+  // One move, then several, then more than a change set holds.
+  for (size_t moves : { 1, 3, 6 }) {
+    for (size_t m = 0; m < moves; m++) {
+      point.mutate(pop);
+    }
+    EXPECT_EQ(pop[0].changes.tracked(), moves <= 4);
+    queens.evaluate(pop);
+    for (auto& cnd : pop) {
+      EXPECT_EQ(pr::fitness(cnd), naive(pr::progeny(cnd)));
+    }
+  }
+
+  // Crossover lists the swapped genes when they are few, which on
+  // eight columns is often.
+  using Small = pr::Candidate<std::array<int, 8>, int>;
+  pr::Population<Small> small(100);
+  for (auto& cnd : small) {
+    std::generate(pr::progeny(cnd).begin(), pr::progeny(cnd).end(),
+      [&]() { return row(mt) % 8; });
+    cnd.alive = true;
+  }
+  pr::Crossover<Small> crossover(2);
+  pr::QueensEvaluator<Small> eight;
+  eight.evaluate(small);
+  size_t listed = 0;
+  for (int round = 0; round < 10; round++) {
+    crossover.mutate(small);
+    for (auto& cnd : small) {
+      listed += cnd.changes.size() > 1;
+    }
+    eight.evaluate(small);
+    for (auto& cnd : small) {
+      // Far apart queens in the extra columns attack nobody.
+      Board board;
+      for (int c = 0; c < Q; c++) {
+        board[c] = -1000 * (c + 1);
+      }
+      std::copy(pr::progeny(cnd).begin(), pr::progeny(cnd).end(),
+        board.begin());
+      EXPECT_EQ(pr::fitness(cnd), naive(board));
+    }
+  }
+  EXPECT_GT(listed, 0);
+
+  // Four moves on eight columns often move the same queen twice.
+  std::vector<int> eightRows(rows.begin(), rows.begin() + 8);
+  pr::Point<Small> move(eightRows, 1.0);
+  for (int round = 0; round < 10; round++) {
+    for (int m = 0; m < 4; m++) {
+      move.mutate(small);
+    }
+    eight.evaluate(small);
+    for (auto& cnd : small) {
+      Board board;
+      for (int c = 0; c < Q; c++) {
+        board[c] = -1000 * (c + 1);
+      }
+      std::copy(pr::progeny(cnd).begin(), pr::progeny(cnd).end(),
+        board.begin());
+      EXPECT_EQ(pr::fitness(cnd), naive(board));
+    }
+  }
+
+  // Strings against a target, compared with the full evaluator.
+  using Text = pr::Candidate<std::string, double>;
+  pr::Population<Text> texts;
+  for (const char* t : { "progeny", "prog", "progenitor", "" }) {
+    texts.push_back(Text(t));
+  }
+  pr::DeltaMismatchEvaluator<Text> delta(std::string("progeny"));
+  pr::MismatchEvaluator<Text> full(std::string("progeny"));
+  pr::Point<Text> letters({ 'x', 'y', 'o' }, 1.0);
+
+  delta.evaluate(texts);
+  for (int round = 0; round < 5; round++) {
+    letters.mutate(texts);
+    EXPECT_TRUE(texts[2].changes.tracked());
+    pr::Population<Text> copies = texts;
+    delta.evaluate(texts);
+    full.evaluate(copies);
+    for (size_t i = 0; i < texts.size(); i++) {
+      EXPECT_EQ(pr::fitness(texts[i]), pr::fitness(copies[i]));
+    }
+  }
+}
+
+TEST(Evaluators, CachingEvaluator) {
+  using Candidate = pr::Candidate<std::string, double>;
+  using Population = pr::Population<Candidate>;
+  using PopItr = Population::iterator;
+  using Counting = pr::CompetitiveEvaluator<Candidate, 1>;
+
+  std::atomic<int> calls(0);
+  Counting counting([&calls](PopItr start, PopItr end){
+    calls++;
+    pr::fitness(*start) = pr::progeny(*start).size();
+  });
+  pr::CachingEvaluator<Candidate, Counting> cev(counting, 16);
+
+  // Duplicates in a batch are evaluated once.
+  Population pop{ "a", "bb", "a", "ccc", "bb", "a" };
+  cev.evaluate(pop);
+  EXPECT_EQ(calls, 3);
+  for (auto& m : pop) {
+    EXPECT_EQ(pr::fitness(m), pr::progeny(m).size());
+  }
+
+  // Valid members are skipped without a lookup.
+  cev.evaluate(pop);
+  EXPECT_EQ(cev.cacheStats().hits + cev.cacheStats().misses, 6u);
+
+  // Known genomes are served from the cache, in bulk and by range.
+  Population next{ "bb", "dddd", "a" };
+  cev.evaluate(next);
+  for (size_t i = 2; i < 5; i++) {
+    pop[i].valid = false;
+  }
+  cev.evaluateRange(pop, 2, 5);
+  EXPECT_EQ(calls, 4);
+  EXPECT_EQ(pr::fitness(next[1]), 4.0);
+
+  auto stats = cev.cacheStats();
+  EXPECT_EQ(stats.hits, 5u);
+  EXPECT_EQ(stats.misses, 7u);
+  EXPECT_EQ(stats.entries, 4u);
+}
+
+TEST(Evaluators, MismatchKernels) {
+  std::mt19937 mt(11);
+  std::uniform_int_distribution<int> coin(0, 3);
+
+  // Every instruction set the CPU has must agree with the scalar kernel,
+  // including on the remainders that do not fill a register.
+  std::vector<pr::Isa> isas{ pr::Isa::Scalar };
+  for (pr::Isa isa : { pr::Isa::SSE2, pr::Isa::AVX2, pr::Isa::AVX512 }) {
+    if (isa <= pr::detectIsa()) {
+      isas.push_back(isa);
+    }
+  }
+
+  for (size_t n : { 0, 1, 15, 16, 63, 64, 65, 300 }) {
+    std::vector<int> target(n);
+    std::vector<std::vector<int>> samples(pr::MismatchBatch, target);
+    const void* ptrs[pr::MismatchBatch];
+    size_t expected[pr::MismatchBatch];
+
+    for (size_t s = 0; s < pr::MismatchBatch; s++) {
+      expected[s] = 0;
+      for (size_t i = 0; i < n; i++) {
+        if (coin(mt) == 0) {
+          samples[s][i] = 1 + coin(mt);
+          expected[s]++;
+        }
+      }
+      ptrs[s] = samples[s].data();
+    }
+
+    for (pr::Isa isa : isas) {
+      size_t counts[pr::MismatchBatch];
+      pr::MismatchKernels<4>::get(isa)(target.data(), ptrs, 
+        pr::MismatchBatch, n, counts);
+      for (size_t s = 0; s < pr::MismatchBatch; s++) {
+        EXPECT_EQ(counts[s], expected[s]);
+      }
+    }
+  }
+
+  // The SSE2 byte kernel counts equal bytes in 8-bit lanes and flushes
+  // them every 255 registers, that is every 4080 bytes, so genomes of
+  // thousands of characters cross flushes. The first sample equals the
+  // target, which overflows a lane that misses its flush.
+  for (size_t n : { 4079, 4080, 4081, 4096, 8160, 8161, 65536 + 17 }) {
+    std::vector<char> target(n, 'a');
+    std::vector<std::vector<char>> samples(pr::MismatchBatch, target);
+    const void* ptrs[pr::MismatchBatch];
+    size_t expected[pr::MismatchBatch];
+
+    for (size_t s = 0; s < pr::MismatchBatch; s++) {
+      expected[s] = 0;
+      for (size_t i = 0; i < n && s > 0; i++) {
+        if (coin(mt) == 0) {
+          samples[s][i] = 'b';
+          expected[s]++;
+        }
+      }
+      ptrs[s] = samples[s].data();
+    }
+
+    for (pr::Isa isa : isas) {
+      size_t counts[pr::MismatchBatch];
+      pr::MismatchKernels<1>::get(isa)(target.data(), ptrs, 
+        pr::MismatchBatch, n, counts);
+      for (size_t s = 0; s < pr::MismatchBatch; s++) {
+        EXPECT_EQ(counts[s], expected[s]) << n;
+      }
+    }
+  }
+
+  // Long strings of different lengths against a reference count.
+  using Candidate = pr::Candidate<std::string, double>;
+  using Population = pr::Population<Candidate>;
+
+  std::string target(1000, 'a');
+  Population pop;
+  for (size_t len : { 1000, 999, 1200, 37, 0, 1000, 513 }) {
+    std::string str(len, 'a');
+    for (auto& c : str) {
+      c = coin(mt) ? 'a' : 'b';
+    }
+    pop.push_back(Candidate(str));
+  }
+
+  pr::MismatchEvaluator<Candidate> mev(target);
+  mev.evaluate(pop);
+  for (auto& cnd : pop) {
+    const std::string& str = pr::progeny(cnd);
+    size_t common = std::min(str.size(), target.size());
+    double error = std::max(str.size(), target.size()) - common;
+    for (size_t i = 0; i < common; i++) {
+      error += str[i] != target[i];
+    }
+    EXPECT_EQ(pr::fitness(cnd), error);
+  }
+}
@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "../src/core/simulation.h"
+#include "../src/core/island_simulation.h"
+#include "../src/util/mailbox.h"
+
+#include "../src/evaluators/mismatch_evaluator.h"
+#include "../src/generators/fill_generator.h"
+#include "../src/selectors/roulette_selector.h"
+#include "../src/mutators/pass_through.h"
+#include "../src/mutators/crossover.h"
+
+TEST(Mailbox, ManyProducers) {
+  pr::Mailbox<int> box;
+
+  std::vector<std::thread> producers;
+  for (int t = 0; t < 4; t++) {
+    producers.emplace_back([&box, t]{
+      for (int i = 0; i < 1000; i++) {
+        box.post(t * 1000 + i);
+      }
+    });
+  }
+  for (auto& p : producers) {
+    p.join();
+  }
+
+  // Messages from a single producer arrive in posting order.
+  std::vector<int> last(4, -1);
+  size_t count = box.receive([&](int v) {
+    EXPECT_GT(v % 1000, last[v / 1000]);
+    last[v / 1000] = v % 1000;
+  });
+
+  EXPECT_EQ(count, 4000);
+  EXPECT_TRUE(box.empty());
+
+  box.post(1);
+  box.post(2);
+  box.clear();
+  EXPECT_TRUE(box.empty());
+  EXPECT_EQ(box.receive([](int) { ADD_FAILURE(); }), 0);
+}
+
+TEST(Simulation, Islands) {
+  using Candidate = pr::Candidate<std::string, double>;
+  using Population = pr::Population<Candidate>;
+
+  pr::FillGenerator<Candidate> fg([]{
+    std::string str(3, 0);
+    std::generate(str.begin(), str.end(), []{
+      const char valid[] = "abcdefghijklmnopqrstuvwxyz";
+      return valid[rand() % 26];
+    });
+    return str;
+  });
+
+  pr::MismatchEvaluator<Candidate> mev("pry");
+  pr::RouletteSelector<Candidate> rs;
+  auto mut = pr::Crossover<Candidate>(2) >> pr::PassThrough<Candidate>();
+  auto sim = pr::Simulation<Candidate>::buildIslands(4, fg, mev, rs, mut);
+  sim->migration(pr::Topology::FullyConnected, 1, 1);
+
+  auto breakpoint = [](const Population& pop, Candidate& elite) {
+    auto match = std::find_if(pop.begin(), pop.end(), [](const Candidate& c){
+      return (pr::fitness(c) == 0.0);
+    });
+
+    if (match != std::end(pop)) {
+      elite = *match;
+      return true;
+    }
+    return false;
+  };
+
+  Candidate elite = sim->evolve(200, 20, breakpoint);
+  EXPECT_EQ(pr::progeny(elite), "pry");
+}
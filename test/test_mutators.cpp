@@ -1,10 +1,15 @@
 #include <gtest/gtest.h>
 #include <iostream>
 #include <vector>
+#include <map>
+#include <cmath>
 
 #include "../src/core/mutator.h"
 #include "../src/mutators/crossover.h"
 #include "../src/mutators/pass_through.h"
+#include "../src/mutators/point.h"
+#include "../src/mutators/split.h"
+#include "../src/mutators/bit_flip.h"
 
 template <typename T>
 class CrossoverTest: public testing::Test {
@@ -142,3 +147,180 @@ TEST(Pipeline, Mutation) {
 }
 
 
+
+TEST(Point, Mutation) {
+  using Candidate = pr::Candidate<std::array<char, 8>, double>;
+  using Population = pr::Population<Candidate>;
+
+  Population pop(100);
+  for (auto& cnd : pop) {
+    pr::progeny(cnd).fill('a');
+    cnd.alive = true;
+  }
+  pop[0].alive = false;
+
+  pr::Point<Candidate> pt({'b'}, 1.0);
+  pt.mutate(pop);
+
+  // Dead members are left alone, living ones change in exactly one place.
+  EXPECT_EQ(std::count(pr::progeny(pop[0]).begin(), 
+    pr::progeny(pop[0]).end(), 'b'), 0);
+  for (size_t i = 1; i < pop.size(); i++) {
+    EXPECT_EQ(std::count(pr::progeny(pop[i]).begin(), 
+      pr::progeny(pop[i]).end(), 'b'), 1);
+  }
+}
+
+TEST(Crossover, BitString) {
+  using Bits = pr::BitString<200>;
+  using Candidate = pr::Candidate<Bits, double>;
+  using Population = pr::Population<Candidate>;
+
+  Population pop{ Bits(), Bits::ones(), Bits(), Bits::ones() };
+  pr::Crossover<Candidate> crossover(3);
+  crossover.mutate(pop);
+
+  // Partners swap whole runs of genes, so each position still holds one
+  // set bit per pair and the unused bits of the last word stay clear.
+  for (size_t p = 0; p < pop.size(); p += 2) {
+    const Bits& a = pr::progeny(pop[p]);
+    const Bits& b = pr::progeny(pop[p + 1]);
+    EXPECT_EQ(a.distance(b), 200);
+    EXPECT_EQ(a.count() + b.count(), 200);
+    EXPECT_FALSE(pop[p].valid);
+
+    int switches = 0;
+    for (size_t i = 1; i < 200; i++) {
+      switches += a.test(i) != a.test(i - 1);
+    }
+    EXPECT_LE(switches, 3);
+  }
+}
+
+TEST(BitFlip, Mutation) {
+  using Bits = pr::BitString<1000>;
+  using Candidate = pr::Candidate<Bits, double>;
+  using Population = pr::Population<Candidate>;
+
+  // Both the sparse and the dense path flip about rate * N bits.
+  for (double rate : { 0.01, 0.3 }) {
+    Population pop(200);
+    for (size_t i = 1; i < pop.size(); i++) {
+      pop[i].alive = true;
+    }
+
+    pr::BitFlip<Candidate> flip(rate);
+    flip.mutate(pop);
+
+    EXPECT_EQ(pr::progeny(pop[0]).count(), 0);
+    size_t flipped = 0;
+    for (size_t i = 1; i < pop.size(); i++) {
+      flipped += pr::progeny(pop[i]).count();
+    }
+    double expected = rate * 1000 * 199;
+    EXPECT_NEAR(flipped, expected, 5 * std::sqrt(expected));
+  }
+}
+
+TEST(Pipeline, Fusion) {
+  using Candidate = pr::Candidate<std::string, double>;
+  using Population = pr::Population<Candidate>;
+
+  static_assert(pr::is_elementwise<pr::Point<Candidate>>::value, 
+    "Point is element-wise.");
+  static_assert(!pr::is_elementwise<pr::Crossover<Candidate>>::value, 
+    "Crossover works on the whole population.");
+
+  pr::Point<Candidate> pa({'x'}, 1.0);
+  pr::Point<Candidate> pb({'y'}, 1.0);
+  pr::Point<Candidate> pc({'z'}, 1.0);
+
+  auto fused = pa >> pb >> pc;
+  static_assert(pr::is_elementwise<decltype(fused)>::value, 
+    "Element-wise stages compose into an element-wise pipeline.");
+
+  auto mixed = pr::Crossover<Candidate>(2) >> pa >> pb;
+  static_assert(!pr::is_elementwise<decltype(mixed)>::value, 
+    "Crossover makes the pipeline population-level.");
+
+  // Fused and staged runs draw from identical engines in the same order,
+  // so they have to agree.
+  Population pop(50);
+  for (auto& cnd : pop) {
+    pr::progeny(cnd) = "aaaaaaaa";
+    cnd.alive = true;
+  }
+  Population staged(pop);
+
+  fused.mutate(pop);
+  pa.mutate(staged);
+  pb.mutate(staged);
+  pc.mutate(staged);
+
+  for (size_t i = 0; i < pop.size(); i++) {
+    EXPECT_EQ(pr::progeny(pop[i]), pr::progeny(staged[i]));
+  }
+
+  Population cross{ "cool", "stuff", "happens", "october" };
+  mixed.mutate(cross);
+  EXPECT_EQ(cross.size(), 4);
+}
+
+TEST(Split, Mutation) {
+  using Candidate = pr::Candidate<std::string, double>;
+  using Population = pr::Population<Candidate>;
+
+  Population pop(12);
+  for (auto& cnd : pop) {
+    pr::progeny(cnd) = "aaaa";
+    cnd.alive = true;
+  }
+  pop[3].alive = false;
+  pop[7].alive = false;
+
+  auto mut = pr::split({0.7, 0.2, 0.1}, 
+    pr::Point<Candidate>({'x'}, 1.0), 
+    pr::Point<Candidate>({'y'}, 1.0),
+    pr::PassThrough<Candidate>());
+  mut.mutate(pop);
+
+  // 10 survivors split into 7, 2 and 1; the dead stay behind untouched.
+  std::map<std::string, int> kinds;
+  for (auto& cnd : pop) {
+    auto& str = pr::progeny(cnd);
+    if (!cnd.alive) {
+      kinds["dead"]++;
+      EXPECT_EQ(str, "aaaa");
+    } else if (str.find('x') != std::string::npos) {
+      kinds["x"]++;
+    } else if (str.find('y') != std::string::npos) {
+      kinds["y"]++;
+    } else {
+      kinds["a"]++;
+    }
+  }
+  EXPECT_EQ(kinds["x"], 7);
+  EXPECT_EQ(kinds["y"], 2);
+  EXPECT_EQ(kinds["a"], 1);
+  EXPECT_EQ(kinds["dead"], 2);
+
+  // Classified branches follow the predicate instead.
+  pr::Split<Candidate, pr::Point<Candidate>, pr::Crossover<Candidate>> 
+    by_length([](const Candidate& cnd) { 
+      return pr::progeny(cnd).size() < 5 ? 0 : 1; 
+    }, pr::Point<Candidate>({'z'}, 1.0), pr::Crossover<Candidate>(1));
+
+  Population mixed{ "abc", "abcdef", "ab", "abcdefg" };
+  by_length.mutate(mixed);
+
+  // Crossover may shorten its children, so only the marked ones are known.
+  int marked = 0;
+  for (auto& cnd : mixed) {
+    auto& str = pr::progeny(cnd);
+    if (str.find('z') != std::string::npos) {
+      EXPECT_LT(str.size(), 5u);
+      marked++;
+    }
+  }
+  EXPECT_EQ(marked, 2);
+}
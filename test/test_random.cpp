@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include <omp.h>
+
+#include "../src/core/random.h"
+#include "../src/generators/fill_generator.h"
+
+TEST(Random, Philox) {
+  // Known answer from the Random123 test vectors.
+  auto bits = pr::Philox::block(pr::Philox::Counter{{0, 0, 0, 0}},
+    pr::Philox::Key{{0, 0}});
+  EXPECT_EQ(bits[0], 0x6627e8d5u);
+  EXPECT_EQ(bits[1], 0xe169c58du);
+  EXPECT_EQ(bits[2], 0xbc57ac4cu);
+  EXPECT_EQ(bits[3], 0x9b00dbd8u);
+
+  pr::Random random(42);
+  auto a = random.stream(0);
+  auto b = random.stream(1);
+  auto c = random.stream(0);
+  EXPECT_NE(a(), b());
+  EXPECT_EQ(random.stream(0)(), c());
+
+  random.next();
+  EXPECT_NE(random.stream(0)(), pr::Random(42).stream(0)());
+  EXPECT_NE(random.fork(0).stream(0)(), random.fork(1).stream(0)());
+}
+
+TEST(Random, ThreadCount) {
+  int threads = omp_get_max_threads();
+  pr::Random random(7);
+
+  std::vector<double> serial(20001), parallel(20001);
+  omp_set_num_threads(1);
+  random.uniform(serial, 3);
+  omp_set_num_threads(4);
+  random.uniform(parallel, 3);
+  EXPECT_EQ(serial, parallel);
+  for (double u : serial) {
+    EXPECT_GE(u, 0.0);
+    EXPECT_LT(u, 1.0);
+  }
+
+  // Members draw from the stream of their index, not of their thread.
+  using Candidate = pr::Candidate<int, double>;
+  auto populate = [&](int n) {
+    pr::FillGenerator<Candidate> gen([](pr::RandomStream& stream) {
+      return static_cast<int>(stream());
+    });
+    gen.seed(random);
+
+    pr::Population<Candidate> pop(257);
+    omp_set_num_threads(n);
+    gen.generate(pop);
+
+    std::vector<int> values;
+    for (auto& cnd : pop) {
+      values.push_back(pr::progeny(cnd));
+    }
+    return values;
+  };
+  EXPECT_EQ(populate(1), populate(4));
+
+  omp_set_num_threads(threads);
+}
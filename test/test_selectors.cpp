@@ -1,7 +1,10 @@
 #include <gtest/gtest.h>
 #include <iostream>
+#include <random>
+#include <algorithm>
 
 #include "../src/selectors/roulette_selector.h"
+#include "../src/selectors/nsga_selector.h"
 
 TEST(Selectors, RouletteSelector) {
   using Candidate = pr::Candidate<int, double>; 
@@ -31,3 +34,134 @@ TEST(Selectors, RouletteSelector) {
 
   EXPECT_EQ(alive_count, 2);
 }
+
+TEST(Selectors, RouletteWithoutReplacement) {
+  using Candidate = pr::Candidate<int, double>; 
+  using Population = pr::Population<Candidate>;
+
+  // Members without weight make up the numbers once the others are gone.
+  Population pop{ {1, 0.0}, {2, 0.0}, {3, 2.0}, {4, 1.0}, {5, 3.0} };
+  pr::RouletteSelector<Candidate> rs;
+  rs.seed(pr::Random(3));
+  rs.select(pop, 4);
+  EXPECT_TRUE(pop[2].alive && pop[3].alive && pop[4].alive);
+  EXPECT_EQ(pop[0].alive + pop[1].alive, 1);
+
+  // A single pick follows the weights.
+  Population pair{ {1, 1.0}, {2, 9.0} };
+  int heavy = 0;
+  for (int trial = 0; trial < 10000; trial++) {
+    rs.select(pair, 1);
+    EXPECT_NE(pair[0].alive, pair[1].alive);
+    heavy += pair[1].alive;
+  }
+  EXPECT_NEAR(heavy / 10000.0, 0.9, 0.015);
+
+  // Every pick is drawn by weight among the members still left.
+  Population three{ {1, 1.0}, {2, 9.0}, {3, 6.0} };
+  int first = 0;
+  for (int trial = 0; trial < 10000; trial++) {
+    rs.select(three, 2);
+    first += three[0].alive;
+  }
+  EXPECT_NEAR(first / 10000.0, 1.0 / 16 + 9.0 / 16 * 1.0 / 7 +
+    6.0 / 16 * 1.0 / 10, 0.015);
+}
+
+TEST(Selectors, RouletteRoundingResidue) {
+  using Candidate = pr::Candidate<int, double>; 
+  using Population = pr::Population<Candidate>;
+
+  // Taking the huge weight out of the tree cancels the tiny ones next to
+  // it, which must not leave the selector drawing forever.
+  for (int seed = 0; seed < 20; seed++) {
+    Population pop;
+    for (int i = 0; i < 1000; i++) {
+      pop.push_back(Candidate(i, 1e-6 * (i + 1)));
+    }
+    pop[seed * 37].second = 1e20;
+
+    pr::RouletteSelector<Candidate> rs;
+    rs.seed(pr::Random(seed));
+    rs.select(pop, 600);
+    EXPECT_TRUE(pop[seed * 37].alive);
+    EXPECT_EQ(std::count_if(pop.begin(), pop.end(), 
+      [](const Candidate& c) { return c.alive; }), 600);
+  }
+}
+
+TEST(Selectors, NSGASelector) {
+  // Integer objectives on a small grid produce plenty of ties.
+  std::mt19937 mt(3);
+  std::uniform_int_distribution<int> dist(0, 20);
+
+  for (size_t m : {2, 3}) {
+    size_t n = 5000;
+    std::vector<double> keys(n * m);
+    for (auto& k : keys) {
+      k = dist(mt);
+    }
+
+    // Reference: peel off the non-dominated points one front at a time.
+    auto dominates = [&](size_t a, size_t b) {
+      bool better = false;
+      for (size_t j = 0; j < m; j++) {
+        if (keys[b * m + j] < keys[a * m + j]) {
+          return false;
+        }
+        better = better || keys[a * m + j] < keys[b * m + j];
+      }
+      return better;
+    };
+
+    std::vector<size_t> expected(n, n);
+    std::vector<size_t> left(n);
+    std::iota(left.begin(), left.end(), 0);
+    for (size_t front = 0; !left.empty(); front++) {
+      std::vector<size_t> rest;
+      for (size_t p : left) {
+        bool dominated = false;
+        for (size_t q : left) {
+          if (dominates(q, p)) {
+            dominated = true;
+            break;
+          }
+        }
+        if (dominated) {
+          rest.push_back(p);
+        } else {
+          expected[p] = front;
+        }
+      }
+      left.swap(rest);
+    }
+
+    EXPECT_EQ(pr::nondominatedSort(keys, n, m), expected);
+  }
+
+  using Candidate = pr::Candidate<int, pr::Objectives<double, 2>>;
+  using Population = pr::Population<Candidate>;
+
+  // A front of five points and a dominated one; the extremes of the front
+  // and the point in its sparsest region survive.
+  Population pop{
+    {0, {0.0, 4.0}},
+    {1, {1.0, 3.0}},
+    {2, {1.5, 2.5}},
+    {3, {3.0, 1.0}},
+    {4, {4.0, 0.0}},
+    {5, {4.0, 4.0}},
+  };
+
+  pr::NSGASelector<Candidate> ns;
+  ns.select(pop, 3, false);
+
+  std::vector<int> alive;
+  for (auto& cnd : pop) {
+    if (cnd.alive) {
+      alive.push_back(pr::progeny(cnd));
+    }
+  }
+  EXPECT_EQ(alive, (std::vector<int>{0, 3, 4}));
+  EXPECT_EQ(ns.ranks()[5], 1u);
+}
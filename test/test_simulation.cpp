@@ -3,16 +3,21 @@
 #include <iostream>
 #include <algorithm>
 #include <vector>
+#include <random>
 
 #include "../src/core/simulation.h"
 #include "../src/core/candidate.h"
 #include "../src/core/population.h"
 
 #include "../src/evaluators/mismatch_evaluator.h"
+#include "../src/evaluators/competitive_evaluator.h"
+#include "../src/evaluators/racing_evaluator.h"
 #include "../src/generators/fill_generator.h"
 #include "../src/selectors/roulette_selector.h"
+#include "../src/selectors/nsga_selector.h"
 #include "../src/mutators/pass_through.h"
 #include "../src/mutators/crossover.h"
+#include "../src/mutators/point.h"
 
 TEST(Simulation, Builder) {
   using Candidate = pr::Candidate<std::string, double>;
@@ -61,3 +66,341 @@ TEST(Simulation, Builder) {
   // Register an observer function that watches the population.
   sim.evolve(10, 2, breakpoint);
 }
+
+TEST(Simulation, SteadyState) {
+  using Candidate = pr::Candidate<std::string, double>;
+  using Population = pr::Population<Candidate>;
+
+  pr::FillGenerator<Candidate> fg([]{
+    std::string str(3, 0);
+    std::generate(str.begin(), str.end(), []{
+      const char valid[] = "abcdefghijklmnopqrstuvwxyz";
+      return valid[rand() % 26];
+    });
+    return str;
+  });
+
+  pr::MismatchEvaluator<Candidate> mev("pry");
+  pr::RouletteSelector<Candidate> rs;
+  // Offspring never come from the generator here, so point mutation has
+  // to bring back letters the population lost.
+  std::vector<char> letters;
+  for (char c = 'a'; c <= 'z'; c++) {
+    letters.push_back(c);
+  }
+  auto mut = pr::Crossover<Candidate>(2) >> 
+    pr::Point<Candidate>(letters, 0.2);
+  auto sim = pr::Simulation<Candidate>::build(fg, mev, rs, mut);
+
+  // Every step must leave the population at its original size.
+  auto breakpoint = [](const Population& pop, Candidate& elite) {
+    EXPECT_EQ(pop.size(), 2000);
+    auto match = std::min_element(pop.begin(), pop.end(), 
+      [](const Candidate& a, const Candidate& b) {
+        return pr::fitness(a) < pr::fitness(b);
+      });
+    elite = *match;
+    return pr::fitness(elite) == 0.0;
+  };
+
+  Candidate elite = sim.evolveSteady(2000, 4, breakpoint);
+  EXPECT_EQ(pr::progeny(elite), "pry");
+}
+
+TEST(Simulation, Asynchronous) {
+  using Candidate = pr::Candidate<std::string, double>;
+  using Population = pr::Population<Candidate>;
+
+  // Generation happens on the calling thread only, so the shared engine
+  // needs no locking.
+  std::mt19937 mt(7);
+  pr::FillGenerator<Candidate> fg([&mt]{
+    std::string str(3, 0);
+    std::generate(str.begin(), str.end(), [&mt]{
+      const char valid[] = "abcdefghijklmnopqrstuvwxyz";
+      return valid[mt() % 26];
+    });
+    return str;
+  });
+
+  pr::MismatchEvaluator<Candidate> mev("pry");
+  pr::RouletteSelector<Candidate> rs;
+  auto mut = pr::Crossover<Candidate>(2) >> pr::PassThrough<Candidate>();
+  auto sim = pr::Simulation<Candidate>::build(fg, mev, rs, mut);
+  sim.asynchronous(4, 7);
+
+  auto breakpoint = [](const Population& pop, Candidate& elite) {
+    auto match = std::find_if(pop.begin(), pop.end(), [](const Candidate& c){
+      return (pr::fitness(c) == 0.0);
+    });
+
+    if (match != std::end(pop)) {
+      elite = *match;
+      return true;
+    }
+    return false;
+  };
+
+  Candidate elite = sim.evolve(500, 50, breakpoint);
+  EXPECT_EQ(pr::progeny(elite), "pry");
+}
+
+TEST(Simulation, ProgressBreakpoint) {
+  using Candidate = pr::Candidate<std::string, double>;
+  using Population = pr::Population<Candidate>;
+  using ProgressData = pr::Simulation<Candidate>::ProgressData;
+
+  pr::FillGenerator<Candidate> fg([]{
+    std::string str(3, 0);
+    std::generate(str.begin(), str.end(), []{
+      const char valid[] = "abcdefghijklmnopqrstuvwxyz";
+      return valid[rand() % 26];
+    });
+    return str;
+  });
+
+  pr::MismatchEvaluator<Candidate> mev("pry");
+  pr::RouletteSelector<Candidate> rs;
+  auto mut = pr::Crossover<Candidate>(2) >> pr::PassThrough<Candidate>();
+  auto sim = pr::Simulation<Candidate>::build(fg, mev, rs, mut);
+  sim.histogram(4);
+
+  // The statistics must agree with the population they were taken from.
+  auto breakpoint = [](const Population& pop, const ProgressData& data,
+      Candidate& elite) {
+    auto best = std::min_element(pop.begin(), pop.end(), 
+      [](const Candidate& a, const Candidate& b) {
+        return pr::fitness(a) < pr::fitness(b);
+      });
+    EXPECT_EQ(pr::fitness(pop[data.bestIndex]), pr::fitness(*best));
+    EXPECT_EQ(pr::fitness(data.bestCandidate), data.minFitness);
+    EXPECT_EQ(data.histogram.size(), 4);
+
+    elite = pop[data.bestIndex];
+    return data.minFitness == 0.0;
+  };
+
+  Candidate elite = sim.evolve(500, 50, breakpoint);
+  EXPECT_EQ(pr::progeny(elite), "pry");
+}
+
+TEST(Simulation, StageTimes) {
+  using Candidate = pr::Candidate<std::string, double>;
+  using Population = pr::Population<Candidate>;
+  using ProgressData = pr::Simulation<Candidate>::ProgressData;
+
+  pr::FillGenerator<Candidate> fg([]{ return std::string("abc"); });
+  pr::MismatchEvaluator<Candidate> mev("pry");
+  pr::RouletteSelector<Candidate> rs;
+  auto mut = pr::Crossover<Candidate>(2) >> pr::PassThrough<Candidate>();
+  auto sim = pr::Simulation<Candidate>::build(fg, mev, rs, mut);
+  sim.asynchronous(3, 8);
+
+  // Every stage takes some time, and no worker can be busy for longer
+  // than the evaluate stage lasted.
+  auto breakpoint = [](const Population&, const ProgressData& data,
+      Candidate&) {
+    auto& times = data.stageTimes;
+    EXPECT_GT(times.select.count(), 0);
+    EXPECT_GT(times.mutate.count(), 0);
+    EXPECT_GT(times.generate.count(), 0);
+    EXPECT_GT(times.evaluate.count(), 0);
+    EXPECT_GT(times.statistics.count(), 0);
+    EXPECT_GT(data.evaluationsPerSecond, 0.0);
+    EXPECT_FALSE(data.threadTimes.empty());
+
+    EXPECT_EQ(data.workerTimes.size(), 3);
+    for (auto& w : data.workerTimes) {
+      EXPECT_LE(w.busy, times.generate + times.evaluate);
+    }
+    return data.generation == 5;
+  };
+
+  sim.evolve(200, 20, breakpoint);
+}
+
+TEST(Simulation, Step) {
+  using Candidate = pr::Candidate<std::string, double>;
+
+  pr::FillGenerator<Candidate> fg([]{
+    std::string str(3, 0);
+    std::generate(str.begin(), str.end(), []{
+      const char valid[] = "abcdefghijklmnopqrstuvwxyz";
+      return valid[rand() % 26];
+    });
+    return str;
+  });
+
+  pr::MismatchEvaluator<Candidate> mev("pry");
+  pr::RouletteSelector<Candidate> rs;
+  auto mut = pr::Crossover<Candidate>(2) >> pr::PassThrough<Candidate>();
+  auto sim = pr::Simulation<Candidate>::build(fg, mev, rs, mut);
+  sim.asynchronous(2, 16);
+
+  auto& data = sim.start(300, 30);
+  EXPECT_EQ(data.generation, 0);
+  EXPECT_EQ(data.evaluations, 300);
+
+  sim.step();
+  EXPECT_EQ(data.generation, 1);
+  sim.step(4);
+  EXPECT_EQ(data.generation, 5);
+  EXPECT_EQ(data.evaluations, 6 * 300);
+
+  // The host decides when to stop.
+  while (data.minFitness > 0.0) {
+    sim.step();
+  }
+  EXPECT_EQ(pr::progeny(data.bestCandidate), "pry");
+  EXPECT_EQ(&sim.progress(), &data);
+}
+
+TEST(Simulation, Objectives) {
+  using Candidate = pr::Candidate<std::string, pr::Objectives<int, 2>>;
+  using Population = pr::Population<Candidate>;
+  using PopItr = Population::iterator;
+  using ProgressData = pr::Simulation<Candidate>::ProgressData;
+
+  pr::FillGenerator<Candidate> fg([](pr::RandomStream& stream){
+    std::uniform_int_distribution<int> letter('a', 'z');
+    std::string str(4, 0);
+    std::generate(str.begin(), str.end(), [&]{ 
+      return static_cast<char>(letter(stream)); 
+    });
+    return str;
+  });
+
+  // Every 'a' helps the first objective and every 'b' the second, so the
+  // Pareto front is made of the strings over {a, b}.
+  pr::CompetitiveEvaluator<Candidate, 1> cev([](PopItr s, PopItr e){
+    const auto& str = pr::progeny(*s);
+    auto& fit = pr::fitness(*s);
+    fit[0] = str.size() - std::count(str.begin(), str.end(), 'a');
+    fit[1] = str.size() - std::count(str.begin(), str.end(), 'b');
+  });
+
+  pr::NSGASelector<Candidate> ns;
+  // Crossover would change the lengths, and with them the objectives.
+  pr::Point<Candidate> mut({'a', 'b'}, 0.5);
+  auto sim = pr::Simulation<Candidate>::build(fg, cev, ns, mut);
+
+  auto breakpoint = [](const Population& pop, const ProgressData& data,
+      Candidate& elite) {
+    EXPECT_EQ(pr::scalar(pr::fitness(data.bestCandidate)), data.minFitness);
+    elite = data.bestCandidate;
+    return data.minFitness == 4.0;
+  };
+
+  Candidate elite = sim.evolve(100, 20, breakpoint);
+  for (char c : pr::progeny(elite)) {
+    EXPECT_TRUE(c == 'a' || c == 'b');
+  }
+}
+
+TEST(Simulation, DirtyTracking) {
+  using Candidate = pr::Candidate<std::string, double>;
+  using Population = pr::Population<Candidate>;
+  using ProgressData = pr::Simulation<Candidate>::ProgressData;
+
+  pr::FillGenerator<Candidate> fg([](pr::RandomStream& stream){
+    std::uniform_int_distribution<int> letter('a', 'z');
+    std::string str(4, 0);
+    std::generate(str.begin(), str.end(), [&]{ 
+      return static_cast<char>(letter(stream)); 
+    });
+    return str;
+  });
+
+  pr::MismatchEvaluator<Candidate> mev("pity");
+  pr::RouletteSelector<Candidate> rs;
+  auto sim = pr::Simulation<Candidate>::build(fg, mev, rs, 
+    pr::PassThrough<Candidate>());
+
+  // Survivors pass through unchanged, so only the refilled members are
+  // evaluated again.
+  size_t last = 0;
+  auto breakpoint = [&last](const Population& pop, const ProgressData& data,
+      Candidate&) {
+    if (data.generation > 1) {
+      EXPECT_EQ(data.evaluations - last, 90u);
+    }
+    for (auto& cnd : pop) {
+      EXPECT_TRUE(cnd.valid);
+    }
+    last = data.evaluations;
+    return data.generation == 5;
+  };
+
+  sim.evolve(100, 10, breakpoint);
+  EXPECT_EQ(last, 100u + 5 * 90);
+}
+
+TEST(Simulation, Racing) {
+  using Candidate = pr::Candidate<std::string, double>;
+  using Population = pr::Population<Candidate>;
+  using Racing = pr::RacingEvaluator<Candidate>;
+
+  // A hundred test cases, each costing one error point per mismatch, with
+  // the race checked every ten.
+  const std::string target = "race";
+  Racing rev([&target](const std::string& str, pr::Race& race) {
+    double error = 0;
+    for (int test = 1; test <= 100; test++) {
+      for (size_t i = 0; i < target.size(); i++) {
+        error += str[i] != target[i];
+      }
+      if (test % 10 == 0 && race.lost(error, test / 100.0)) {
+        break;
+      }
+    }
+    return error;
+  });
+
+  Population pop;
+  pop.push_back(Candidate("rack"));
+  pop.push_back(Candidate("rice"));
+  pop.push_back(Candidate("mice"));
+  rev.threshold(150);
+  rev.evaluate(pop);
+  EXPECT_EQ(pr::fitness(pop[0]), 100);
+  EXPECT_EQ(pr::fitness(pop[1]), 100);
+  EXPECT_EQ(pr::fitness(pop[2]), 160);
+  EXPECT_FALSE(pop[2].valid);
+  EXPECT_TRUE(pop[2].estimated);
+
+  pr::RaceStats stats = rev.raceStats();
+  EXPECT_EQ(stats.evaluations, 3u);
+  EXPECT_EQ(stats.aborted, 1u);
+  EXPECT_NEAR(stats.savedWork, 0.2, 1e-12);
+  EXPECT_EQ(stats.threshold, 150);
+
+  // An abandoned member that survives selection is scored in full next
+  // time, whatever the threshold.
+  rev.evaluate(pop);
+  EXPECT_EQ(pr::fitness(pop[2]), 200);
+  EXPECT_TRUE(pop[2].valid);
+  EXPECT_FALSE(pop[2].estimated);
+  EXPECT_EQ(rev.raceStats().evaluations, 4u);
+  EXPECT_EQ(rev.raceStats().aborted, 1u);
+
+  // The simulation publishes the median of every generation.
+  pr::FillGenerator<Candidate> fg([](pr::RandomStream& stream){
+    std::uniform_int_distribution<int> letter('a', 'z');
+    std::string str(4, 0);
+    std::generate(str.begin(), str.end(), [&]{ 
+      return static_cast<char>(letter(stream)); 
+    });
+    return str;
+  });
+  pr::RouletteSelector<Candidate> rs;
+  auto sim = pr::Simulation<Candidate>::build(fg, Racing(rev), rs, 
+    pr::PassThrough<Candidate>());
+  sim.racing(0.5);
+
+  auto& data = sim.start(200, 50);
+  sim.step(5);
+  EXPECT_LT(data.racing.threshold, 400);
+  EXPECT_GT(data.racing.aborted, 0u);
+  EXPECT_GT(data.racing.savedWork, 0.0);
+  EXPECT_EQ(data.racing.evaluations, 4 + data.evaluations);
+}
@@ -0,0 +1,50 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <numeric>
+
+#include "../src/core/statistics.h"
+
+TEST(Statistics, Summarize) {
+  using Candidate = pr::Candidate<int, double>;
+
+  // A large offset makes the naive sum of squares lose every digit.
+  std::mt19937 mt(7);
+  std::uniform_real_distribution<double> dist(0.0, 1.0);
+  pr::Population<Candidate> pop(10001);
+  for (auto& cnd : pop) {
+    pr::fitness(cnd) = 1e9 + dist(mt);
+  }
+  pr::fitness(pop[4321]) = 1e9 - 1.0;
+  pr::fitness(pop[77]) = 1e9 + 2.0;
+
+  // The reference is computed on shifted values, which keeps it exact.
+  double shifted = 0.0;
+  for (auto& cnd : pop) {
+    shifted += pr::fitness(cnd) - 1e9;
+  }
+  shifted /= pop.size();
+  double mean = 1e9 + shifted;
+
+  double var = 0.0;
+  for (auto& cnd : pop) {
+    double d = (pr::fitness(cnd) - 1e9) - shifted;
+    var += d * d;
+  }
+  var /= pop.size() - 1;
+
+  pr::FitnessSummary summary = pr::summarize(pop);
+  EXPECT_EQ(summary.count, pop.size());
+  EXPECT_NEAR(summary.mean, mean, 1e-4);
+  EXPECT_NEAR(summary.variance(), var, 1e-6);
+  EXPECT_EQ(summary.min, 1e9 - 1.0);
+  EXPECT_EQ(summary.minIndex, 4321);
+  EXPECT_EQ(summary.max, 1e9 + 2.0);
+  EXPECT_EQ(summary.maxIndex, 77);
+
+  auto counts = pr::histogram(pop, 3, summary.min, summary.max);
+  ASSERT_EQ(counts.size(), 3);
+  EXPECT_EQ(counts[0], 1);
+  EXPECT_EQ(counts[2], 1);
+  EXPECT_EQ(std::accumulate(counts.begin(), counts.end(), size_t(0)),
+    pop.size());
+}
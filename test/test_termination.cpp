@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <algorithm>
+
+#include "../src/core/simulation.h"
+#include "../src/core/termination.h"
+
+#include "../src/evaluators/mismatch_evaluator.h"
+#include "../src/generators/fill_generator.h"
+#include "../src/selectors/roulette_selector.h"
+#include "../src/mutators/pass_through.h"
+#include "../src/mutators/crossover.h"
+
+TEST(Termination, Compose) {
+  using Candidate = pr::Candidate<std::string, double>;
+  using ProgressData = pr::Simulation<Candidate>::ProgressData;
+
+  // Stagnation must keep counting even while the other criterion decides.
+  auto stop = pr::Stagnation<Candidate>(3) && 
+    pr::EvaluationBudget<Candidate>(50);
+
+  ProgressData data;
+  data.minFitness = 5.0;
+  std::vector<bool> fired;
+  for (int gen = 0; gen < 6; gen++) {
+    data.evaluations += 10;
+    fired.push_back(stop.test(data));
+  }
+  EXPECT_EQ(fired, std::vector<bool>({false, false, false, false, true, true}));
+
+  auto any = pr::TargetFitness<Candidate>(1.0) || 
+    pr::Deadline<Candidate>(std::chrono::milliseconds(500));
+  data.elapsedTime = 0.2;
+  EXPECT_FALSE(any.test(data));
+  data.elapsedTime = 0.5;
+  EXPECT_TRUE(any.test(data));
+  data.elapsedTime = 0.0;
+  data.minFitness = 1.0;
+  EXPECT_TRUE(any.test(data));
+}
+
+TEST(Termination, Simulation) {
+  using Candidate = pr::Candidate<std::string, double>;
+
+  pr::FillGenerator<Candidate> fg([]{
+    std::string str(3, 0);
+    std::generate(str.begin(), str.end(), []{
+      const char valid[] = "abcdefghijklmnopqrstuvwxyz";
+      return valid[rand() % 26];
+    });
+    return str;
+  });
+
+  pr::MismatchEvaluator<Candidate> mev("pry");
+  pr::RouletteSelector<Candidate> rs;
+  auto mut = pr::Crossover<Candidate>(2) >> pr::PassThrough<Candidate>();
+  auto sim = pr::Simulation<Candidate>::build(fg, mev, rs, mut);
+
+  // An unreachable target leaves the evaluation budget to end the run.
+  Candidate elite = sim.evolve(100, 10, 
+    pr::TargetFitness<Candidate>(-1.0) || 
+    pr::EvaluationBudget<Candidate>(1000));
+
+  EXPECT_EQ(sim.population().size(), 100);
+  auto best = std::min_element(sim.population().begin(), 
+    sim.population().end(), [](const Candidate& a, const Candidate& b) {
+      return pr::fitness(a) < pr::fitness(b);
+    });
+  EXPECT_EQ(pr::fitness(elite), pr::fitness(*best));
+}
@@ -0,0 +1,28 @@
+#include <array>
+#include <string>
+#include <cstdlib>
+
+#include <util/process_worker.h>
+
+// Stand-in worker for the ProcessEvaluator test. Scores the sum of eight
+// doubles; with "--crash N" it aborts on the Nth batch it receives.
+int main(int argc, char** argv) {
+  size_t crash = 0;
+  if (argc > 2 && std::string(argv[1]) == "--crash") {
+    crash = std::strtoul(argv[2], nullptr, 10);
+  }
+
+  size_t batches = 0;
+  return pr::serveWorker<std::array<double, 8>, double>(
+    [&](const std::array<double, 8>* genomes, size_t count, double* fitness) {
+      if (++batches == crash) {
+        std::abort();
+      }
+      for (size_t i = 0; i < count; i++) {
+        fitness[i] = 0;
+        for (double g : genomes[i]) {
+          fitness[i] += g;
+        }
+      }
+    });
+}